@@ -1,6 +1,7 @@
 #include <Arduino.h>
 #include "CheckersGame.h"
 #include "MinimaxAI.h"
+#include "ProofNumberSolver.h"
 
 // Configure both players as COMPUTER.
 enum PlayerType { HUMAN, COMPUTER };
@@ -8,7 +9,37 @@ PlayerType player_ai_type = COMPUTER;
 PlayerType player_human_type = COMPUTER;
 
 CheckersGame game;
+
+// The engine reserves a search frame for each of MINIMAX_MAX_PLY plies
+// (10 by default), but this sketch only searches OPTION_DEPTH (4) deep.
+// Build with -DMINIMAX_MAX_PLY=4 to match and save about 6 frames of SRAM,
+// for example with arduino-cli:
+//   arduino-cli compile --build-property "compiler.cpp.extra_flags=-DMINIMAX_MAX_PLY=4"
+// The flag must reach the library as well as the sketch, so do not #define
+// it here. Keep it at least OPTION_DEPTH or the search is clamped shallower.
 MinimaxAI ai(game, OPTION_DEPTH);
+static_assert(MINIMAX_MAX_PLY >= OPTION_DEPTH, "MINIMAX_MAX_PLY is below the sketch's OPTION_DEPTH");
+
+// One saved state per search ply lets the engine copy the small CheckersState
+// instead of replaying undo records.
+CheckersState searchStates[OPTION_DEPTH];
+
+// Endgame mode: with this many pieces or fewer left on the board, the
+// proof-number solver looks for a forced win before the regular search
+// runs (0 = off). It needs about 1KB for its hash area (64 entries of 15
+// bytes) and, on AVR, a 92-byte ProofFrame per ply for its stack: about 3KB
+// with the default PROOF_MAX_PLY of 32. On boards with 2KB of SRAM also
+// build with a small PROOF_MAX_PLY (for example -DPROOF_MAX_PLY=12, about
+// 1.1KB).
+#define ENDGAME_PIECES 0
+#define ENDGAME_NODES 2000   // Solver node budget per move
+#define ENDGAME_PLIES 12     // Longest forced win looked for
+
+#if ENDGAME_PIECES > 0
+ProofEntry endgameEntries[64];
+ProofNumberSolver endgame(game, endgameEntries, 64);
+CheckersState endgameStates[ENDGAME_PLIES];
+#endif
 
 // Reads human move input from Serial (if needed).
 bool readHumanMove(Move &move) {
@@ -26,17 +57,20 @@ bool readHumanMove(Move &move) {
   return false;
 }
 
-void setup() {
-  Serial.begin(115200);
-  while (!Serial) { /* Wait for Serial */ }
-  
-  Serial.println(F("Checkers AI Game"));
-  Serial.println(F("Enter moves as: <from> <to> (numbers 1-32)"));
-  game.reset_game();
+// Nodes the engine searches per pass through loop().
+// Smaller values keep Serial more responsive, larger values think faster.
+#define NODES_PER_LOOP 64
+
+bool humanTurn = false;       // Whose turn it is on the real board.
+bool engineThinking = false;  // True once the engine search for this turn has started.
+Move legalMoves[32];          // Legal moves for the human, generated before pondering.
+uint8_t legalCount = 0;
+
+// Called after a move has been made on the real board.
+// Prints the board, checks for the end of the game and sets up the next turn.
+void moveMade(bool byEngine) {
   game.printBoard();
-}
 
-void loop() {
   if (game.isGameOver()) {
     int score = game.evaluateBoard();
     if (score > 0) Serial.println(F("AI wins!"));
@@ -44,45 +78,117 @@ void loop() {
     else Serial.println(F("Draw!"));
     while (true) { delay(1000); }
   }
-  
+
   // Determine whose turn it is.
-  bool humanTurn = false;
   if (game.currentSide == SIDE_AI)
     humanTurn = (player_ai_type == HUMAN);
   else
     humanTurn = (player_human_type == HUMAN);
+
+  engineThinking = false;
+  if (humanTurn) {
+    legalCount = game.generateMoves(legalMoves);
+    // Think about the expected reply while the human is thinking.
+    Move predicted;
+    if (byEngine && ai.getPonderMove(predicted)) {
+      ai.startPonder(predicted);
+    }
+  }
+}
+
+#if ENDGAME_PIECES > 0
+// Plays a forced win if few enough pieces are left and the solver finds one.
+// Returns true if it made a move.
+bool playEndgameWin() {
+  uint8_t pieces = 0;
+  for (uint32_t bits = game.board.ai | game.board.human; bits != 0; bits &= bits - 1) {
+    pieces++;
+  }
+  if (pieces > ENDGAME_PIECES || endgame.solve(ENDGAME_NODES) != PROOF_WIN) {
+    return false;
+  }
+  Move winMove = endgame.getProofMove();
+  Serial.print(F("AI plays forced win from "));
+  Serial.print(winMove.from + 1);
+  Serial.print(F(" to "));
+  Serial.println(winMove.to + 1);
+  game.applyMove(winMove);
+  moveMade(false);
+  return true;
+}
+#endif
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) { /* Wait for Serial */ }
   
-  Move moves[32];
-  uint8_t moveCount = game.generateMoves(moves);
-  if (moveCount == 0) return;  // Should not occur if game is not over.
-  
+  Serial.println(F("Checkers AI Game"));
+  Serial.println(F("Enter moves as: <from> <to> (numbers 1-32)"));
+  Serial.print(F("Engine search stack: "));
+  Serial.print(MinimaxAI::SEARCH_STACK_BYTES);
+  Serial.println(F(" bytes"));
+  game.reset_game();
+  ai.setStateBuffer(searchStates, sizeof(searchStates));
+#if ENDGAME_PIECES > 0
+  endgame.setMaxPly(ENDGAME_PLIES);
+  endgame.setStateBuffer(endgameStates, sizeof(endgameStates));
+#endif
+  moveMade(false);
+}
+
+void loop() {
   if (humanTurn) {
-    if (Serial.available() > 0) {
-      Move humanMove;
-      if (readHumanMove(humanMove)) {
-        bool legal = false;
-        for (uint8_t i = 0; i < moveCount; i++) {
-          if (moves[i].from == humanMove.from && moves[i].to == humanMove.to) {
-            legal = true;
-            break;
-          }
-        }
-        if (legal) {
-          game.applyMove(humanMove);
-          game.printBoard();
-        } else {
-          Serial.println(F("Illegal move. Try again."));
+    // Use the human's thinking time to search the predicted position.
+    if (ai.isPondering()) {
+      ai.stepSearch(NODES_PER_LOOP);
+    }
+
+    Move humanMove;
+    if (readHumanMove(humanMove)) {
+      bool legal = false;
+      for (uint8_t i = 0; i < legalCount; i++) {
+        if (legalMoves[i].from == humanMove.from && legalMoves[i].to == humanMove.to) {
+          legal = true;
+          break;
         }
       }
+      if (!legal) {
+        Serial.println(F("Illegal move. Try again."));
+      } else if (ai.ponderHit(humanMove)) {
+        // The predicted move is already on the board and the engine keeps its search.
+        moveMade(false);
+        if (humanTurn)
+          ai.cancelSearch();  // Still the human's turn (multi-jump): the search is not ours.
+        else
+          engineThinking = true;
+      } else {
+        game.applyMove(humanMove);
+        moveMade(false);
+      }
     }
   } else {
-    Move aiMove = ai.findBestMove();
-    Serial.print(F("AI plays move from "));
-    Serial.print(aiMove.from + 1);
-    Serial.print(F(" to "));
-    Serial.println(aiMove.to + 1);
-    game.applyMove(aiMove);
-    game.printBoard();
-    delay(500);
+    // Search a slice at a time so loop() keeps running while the engine thinks.
+    if (!engineThinking) {
+#if ENDGAME_PIECES > 0
+      if (playEndgameWin()) {
+        return;
+      }
+#endif
+      ai.startSearch();
+      engineThinking = true;
+    }
+    if (ai.stepSearch(NODES_PER_LOOP)) {
+      Move aiMove = ai.getResult();
+      Serial.print(F("AI plays move from "));
+      Serial.print(aiMove.from + 1);
+      Serial.print(F(" to "));
+      Serial.println(aiMove.to + 1);
+#ifdef MINIMAX_PROFILE
+      ai.printProfile();  // Where the search time went (build with -DMINIMAX_PROFILE).
+#endif
+      game.applyMove(aiMove);
+      moveMade(true);
+      delay(500);
+    }
   }
 }
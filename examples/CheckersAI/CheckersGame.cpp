@@ -1,5 +1,9 @@
 #include "CheckersGame.h"
 
+#if !defined(ARDUINO) && defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 // Constructor.
 CheckersGame::CheckersGame() {
     reset_game();
@@ -8,14 +12,39 @@ CheckersGame::CheckersGame() {
     historySize = 0;
 }
 
-// Compute a simple hash for the board by folding in each square’s raw value.
+// Number of set bits in each 4-bit value (one board row).
+static const uint8_t nibbleBits[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+// Count the pieces in a bitboard.
+static uint8_t countPieces(uint32_t bits) {
+    uint8_t count = 0;
+    for (; bits != 0; bits >>= 4) {
+        count += nibbleBits[bits & 0xF];
+    }
+    return count;
+}
+
+// Compute a simple hash for a board by folding the three bitboards together.
+static uint16_t hashBoard(const CheckersBoard &b) {
+    // A simple multiplicative hash (you can adjust the constants)
+    uint32_t hash = (b.ai * 0x9E3779B1UL) ^ (b.human * 0x85EBCA77UL) ^ (b.kings * 0xC2B2AE3DUL);
+    return (uint16_t)(hash ^ (hash >> 16));
+}
+
 uint16_t CheckersGame::computeBoardHash() {
-    uint16_t hash = 0;
-    for (uint8_t i = 0; i < NUM_SQUARES; i++) {
-        // A simple multiplicative hash (you can adjust the constant)
-        hash = (hash * 33) ^ board[i].raw;
+    return hashBoard(board);
+}
+
+// Read the piece on a board index.
+CheckerPiece CheckersGame::pieceAt(uint8_t index) const {
+    uint32_t bit = 1UL << index;
+    CheckerPiece piece;
+    piece.raw = 0;
+    if ((board.ai | board.human) & bit) {
+        piece.bits.type = (board.kings & bit) ? CP_KING : CP_MAN;
+        piece.bits.side = (board.ai & bit) ? SIDE_AI : SIDE_HUMAN;
     }
-    return hash;
+    return piece;
 }
 
 // Reset board to initial checkers position.
@@ -24,68 +53,217 @@ uint16_t CheckersGame::computeBoardHash() {
 // Rows 3-4 (indices 12–19): empty
 // Rows 5-7 (indices 20–31): Human pieces (men)
 void CheckersGame::reset_game() {
-    for (uint8_t i = 0; i < NUM_SQUARES; i++) {
-        board[i].raw = 0;
-    }
-    // Place AI pieces (indices 0–11)
-    for (uint8_t i = 0; i < 12; i++) {
-        board[i].bits.type = CP_MAN;
-        board[i].bits.side = SIDE_AI;
-    }
-    // Indices 12 to 19 remain empty.
-    for (uint8_t i = 12; i < 20; i++) {
-        board[i].raw = 0;
-    }
+    // Place AI pieces (indices 0–11); indices 12 to 19 remain empty.
+    board.ai = 0x00000FFFUL;
     // Place Human pieces (indices 20–31)
-    for (uint8_t i = 20; i < NUM_SQUARES; i++) {
-        board[i].bits.type = CP_MAN;
-        board[i].bits.side = SIDE_HUMAN;
-    }
+    board.human = 0xFFF00000UL;
+    board.kings = 0;
     // Let AI move first.
     currentSide = SIDE_AI;
     undoStackIndex = 0;
+    lastMove = {0, 0};
     lastMoveValid = false;
     historySize = 0;
     boardHistory[historySize++] = computeBoardHash();
 }
 
+// Material and advancement score of a board.
+static int materialScore(const CheckersBoard &b) {
+    int score = 0;
+    // Men are scored a row (4 squares) at a time.
+    uint32_t aiMen = b.ai & ~b.kings;
+    uint32_t humanMen = b.human & ~b.kings;
+    for (uint8_t row = 0; row < 8; row++, aiMen >>= 4, humanMen >>= 4) {
+        // For AI pieces (which move down), reward higher row numbers.
+        score += nibbleBits[aiMen & 0xF] * (3 + row);
+        // For Human pieces (which move up), reward lower row numbers.
+        score -= nibbleBits[humanMen & 0xF] * (3 + (7 - row));
+    }
+    score += 5 * countPieces(b.ai & b.kings);
+    score -= 5 * countPieces(b.human & b.kings);
+    return score;
+}
+
 // Enhanced evaluation function: adds a bonus for advancing pieces
 // and subtracts a penalty if the current board state is repeated.
 int CheckersGame::evaluateBoard() {
-    int score = 0;
-    for (uint8_t i = 0; i < NUM_SQUARES; i++) {
-        if (board[i].bits.type == CP_MAN) {
-            int bonus = 0;
-            uint8_t row, col;
-            indexToCoord(i, row, col);
-            // For AI pieces (which move down), reward higher row numbers.
-            if (board[i].bits.side == SIDE_AI)
-                bonus = row;
-            else  // For Human pieces (which move up), reward lower row numbers.
-                bonus = (7 - row);
-            if (board[i].bits.side == SIDE_AI)
-                score += 3 + bonus;
-            else
-                score -= 3 + bonus;
-        } else if (board[i].bits.type == CP_KING) {
-            if (board[i].bits.side == SIDE_AI) score += 5;
-            else score -= 5;
-        }
+    // A side with no pieces left has lost.
+    if (board.human == 0) return +SCORE_WIN;
+    if (board.ai == 0) return -SCORE_WIN;
+    return materialScore(board) - repetitionPenalty();
+}
+
+// Repetition penalty: if the current board hash appears more than once in the history,
+// return a penalty that discourages cycles.
+int CheckersGame::repetitionPenalty() {
+    return repetitionPenalty(computeBoardHash(), 0);
+}
+
+// The penalty for a board hash, counting it extra times on top of the history.
+int CheckersGame::repetitionPenalty(uint16_t hash, uint8_t extra) {
+    uint8_t repetitions = extra;
+#if !defined(ARDUINO) && defined(__SSE2__)
+    // Compare eight history entries at a time. Entries from historySize on
+    // are scratch and masked off; the array holds whole groups of eight.
+    static_assert(sizeof(boardHistory) % 16 == 0, "boardHistory must hold a multiple of 8 entries");
+    const __m128i key = _mm_set1_epi16((short)hash);
+    const __m128i size = _mm_set1_epi16(historySize);
+    for (uint8_t i = 0; i < historySize; i += 8) {
+        __m128i index = _mm_add_epi16(_mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7), _mm_set1_epi16(i));
+        __m128i hits = _mm_and_si128(_mm_cmpeq_epi16(_mm_loadu_si128((const __m128i *)&boardHistory[i]), key),
+                                     _mm_cmplt_epi16(index, size));
+        repetitions += __builtin_popcount(_mm_movemask_epi8(hits)) / 2;  // Two mask bits per entry
     }
-    // Repetition penalty: if the current board hash appears more than once in the history,
-    // subtract a penalty to discourage cycles.
-    uint16_t currentHash = computeBoardHash();
-    uint8_t repetitions = 0;
+#else
     for (uint8_t i = 0; i < historySize; i++) {
-        if (boardHistory[i] == currentHash)
+        if (boardHistory[i] == hash)
             repetitions++;
     }
-    if (repetitions > 1) {
-        // Subtract 10 points for each repeated occurrence beyond the first.
-        score -= 10 * (repetitions - 1);
+#endif
+    // 10 points for each repeated occurrence beyond the first.
+    return (repetitions > 1) ? 10 * (repetitions - 1) : 0;
+}
+
+#if !defined(ARDUINO)
+// Squares on the rows whose number has bit 0, 1 or 2 set. A man on row r is
+// worth 3 + r to the AI and 10 - r to the Human, and r is the sum of these
+// bits, so the row terms of evaluateBoard() come down to masked popcounts.
+#define ROW_BIT0_SQUARES 0xF0F0F0F0UL
+#define ROW_BIT1_SQUARES 0xFF00FF00UL
+#define ROW_BIT2_SQUARES 0xFFFF0000UL
+
+// Vector lanes processed at a time, and the batch size rounded up to them.
+#if defined(__AVX2__)
+#define BATCH_LANES 8
+#elif defined(__SSE2__)
+#define BATCH_LANES 4
+#else
+#define BATCH_LANES 1
+#endif
+#define BATCH_SIZE ((MAX_MOVES + BATCH_LANES - 1) / BATCH_LANES * BATCH_LANES)
+
+// The boards of a batch of positions, one array per bitboard so that the
+// same bitboard of several positions loads into one vector.
+struct CheckersBatch {
+    uint32_t aiMen[BATCH_SIZE];
+    uint32_t humanMen[BATCH_SIZE];
+    uint32_t aiKings[BATCH_SIZE];
+    uint32_t humanKings[BATCH_SIZE];
+};
+
+#if defined(__AVX2__)
+// Population count of each 32-bit lane: look up the bits of each nibble,
+// then add up the four bytes of every lane.
+static inline __m256i lanePopcount(__m256i v) {
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                           0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(table, _mm256_and_si256(v, nibble)),
+                                    _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble)));
+    return _mm256_madd_epi16(_mm256_maddubs_epi16(bytes, _mm256_set1_epi8(1)), _mm256_set1_epi16(1));
+}
+
+// Row weights of the men in each lane: the sum of their row numbers.
+static inline __m256i laneRows(__m256i men) {
+    __m256i rows = lanePopcount(_mm256_and_si256(men, _mm256_set1_epi32((int)ROW_BIT0_SQUARES)));
+    rows = _mm256_add_epi32(rows, _mm256_slli_epi32(
+        lanePopcount(_mm256_and_si256(men, _mm256_set1_epi32((int)ROW_BIT1_SQUARES))), 1));
+    return _mm256_add_epi32(rows, _mm256_slli_epi32(
+        lanePopcount(_mm256_and_si256(men, _mm256_set1_epi32((int)ROW_BIT2_SQUARES))), 2));
+}
+
+static void scoreBatch(const CheckersBatch &batch, uint8_t count, int *scores) {
+    for (uint8_t i = 0; i < count; i += BATCH_LANES) {
+        __m256i aiMen = _mm256_loadu_si256((const __m256i *)&batch.aiMen[i]);
+        __m256i humanMen = _mm256_loadu_si256((const __m256i *)&batch.humanMen[i]);
+        __m256i kings = _mm256_sub_epi32(lanePopcount(_mm256_loadu_si256((const __m256i *)&batch.aiKings[i])),
+                                         lanePopcount(_mm256_loadu_si256((const __m256i *)&batch.humanKings[i])));
+        __m256i score = _mm256_mullo_epi32(lanePopcount(aiMen), _mm256_set1_epi32(3));
+        score = _mm256_sub_epi32(score, _mm256_mullo_epi32(lanePopcount(humanMen), _mm256_set1_epi32(10)));
+        score = _mm256_add_epi32(score, _mm256_add_epi32(laneRows(aiMen), laneRows(humanMen)));
+        score = _mm256_add_epi32(score, _mm256_mullo_epi32(kings, _mm256_set1_epi32(5)));
+        _mm256_storeu_si256((__m256i *)&scores[i], score);
     }
-    return score;
 }
+#elif defined(__SSE2__)
+// Population count of each 32-bit lane with SSE2 alone: add up bit pairs,
+// then nibbles, then bytes.
+static inline __m128i lanePopcount(__m128i v) {
+    v = _mm_sub_epi32(v, _mm_and_si128(_mm_srli_epi32(v, 1), _mm_set1_epi32(0x55555555)));
+    v = _mm_add_epi32(_mm_and_si128(v, _mm_set1_epi32(0x33333333)),
+                      _mm_and_si128(_mm_srli_epi32(v, 2), _mm_set1_epi32(0x33333333)));
+    v = _mm_and_si128(_mm_add_epi32(v, _mm_srli_epi32(v, 4)), _mm_set1_epi32(0x0F0F0F0F));
+    v = _mm_add_epi32(v, _mm_srli_epi32(v, 8));
+    return _mm_and_si128(_mm_add_epi32(v, _mm_srli_epi32(v, 16)), _mm_set1_epi32(0x3F));
+}
+
+// Row weights of the men in each lane: the sum of their row numbers.
+static inline __m128i laneRows(__m128i men) {
+    __m128i rows = lanePopcount(_mm_and_si128(men, _mm_set1_epi32((int)ROW_BIT0_SQUARES)));
+    rows = _mm_add_epi32(rows, _mm_slli_epi32(lanePopcount(_mm_and_si128(men, _mm_set1_epi32((int)ROW_BIT1_SQUARES))), 1));
+    return _mm_add_epi32(rows, _mm_slli_epi32(lanePopcount(_mm_and_si128(men, _mm_set1_epi32((int)ROW_BIT2_SQUARES))), 2));
+}
+
+// SSE2 has no 32-bit multiply, so the piece values are shifts and adds.
+static void scoreBatch(const CheckersBatch &batch, uint8_t count, int *scores) {
+    for (uint8_t i = 0; i < count; i += BATCH_LANES) {
+        __m128i aiMen = _mm_loadu_si128((const __m128i *)&batch.aiMen[i]);
+        __m128i humanMen = _mm_loadu_si128((const __m128i *)&batch.humanMen[i]);
+        __m128i kings = _mm_sub_epi32(lanePopcount(_mm_loadu_si128((const __m128i *)&batch.aiKings[i])),
+                                      lanePopcount(_mm_loadu_si128((const __m128i *)&batch.humanKings[i])));
+        __m128i aiCount = lanePopcount(aiMen);
+        __m128i humanCount = lanePopcount(humanMen);
+        __m128i score = _mm_add_epi32(aiCount, _mm_slli_epi32(aiCount, 1));             // 3 per AI man
+        score = _mm_sub_epi32(score, _mm_add_epi32(_mm_slli_epi32(humanCount, 3),
+                                                   _mm_slli_epi32(humanCount, 1)));    // 10 per Human man
+        score = _mm_add_epi32(score, _mm_add_epi32(laneRows(aiMen), laneRows(humanMen)));
+        score = _mm_add_epi32(score, _mm_add_epi32(_mm_slli_epi32(kings, 2), kings));  // 5 per king
+        _mm_storeu_si128((__m128i *)&scores[i], score);
+    }
+}
+#else
+static void scoreBatch(const CheckersBatch &batch, uint8_t count, int *scores) {
+    for (uint8_t i = 0; i < count; i++) {
+        CheckersBoard b = { batch.aiMen[i] | batch.aiKings[i], batch.humanMen[i] | batch.humanKings[i],
+                            batch.aiKings[i] | batch.humanKings[i] };
+        scores[i] = materialScore(b);
+    }
+}
+#endif
+
+// Collect the child boards, then score them together. Only the boards are
+// needed, so the moves are played on copies of the board alone. Wins and
+// the repetition penalty, which needs the history, are settled per child.
+bool CheckersGame::evaluateMoves(const Move *moves, uint8_t count, int *scores) {
+    // A played move adds its board to the history while there is room.
+    uint8_t recorded = (historySize < sizeof(boardHistory) / sizeof(boardHistory[0])) ? 1 : 0;
+    CheckersBatch batch;
+    int8_t winner[MAX_MOVES];
+    int penalty[MAX_MOVES];
+    for (uint8_t i = 0; i < count; i++) {
+        CheckersBoard child = board;
+        moveOnBoard(moves[i], child);
+        batch.aiMen[i] = child.ai & ~child.kings;
+        batch.humanMen[i] = child.human & ~child.kings;
+        batch.aiKings[i] = child.ai & child.kings;
+        batch.humanKings[i] = child.human & child.kings;
+        winner[i] = (child.human == 0) ? 1 : (child.ai == 0 ? -1 : 0);
+        penalty[i] = repetitionPenalty(hashBoard(child), recorded);
+    }
+    // Unused lanes of the last vector score empty boards.
+    uint8_t padded = (count + BATCH_LANES - 1) / BATCH_LANES * BATCH_LANES;
+    for (uint8_t i = count; i < padded; i++) {
+        batch.aiMen[i] = batch.humanMen[i] = batch.aiKings[i] = batch.humanKings[i] = 0;
+    }
+
+    int laneScores[BATCH_SIZE];
+    scoreBatch(batch, padded, laneScores);
+    for (uint8_t i = 0; i < count; i++) {
+        scores[i] = (winner[i] != 0) ? winner[i] * SCORE_WIN : laneScores[i] - penalty[i];
+    }
+    return true;
+}
+#endif
 
 // Check if (row, col) is within 0–7.
 bool CheckersGame::isValidCoord(int row, int col) {
@@ -122,8 +300,10 @@ uint8_t CheckersGame::generatePieceMoves(uint8_t index, Move *moves, bool forceC
     uint8_t count = 0;
     uint8_t row, col;
     indexToCoord(index, row, col);
-    CheckerPiece piece = board[index];
+    CheckerPiece piece = pieceAt(index);
     if (piece.bits.type == CP_EMPTY) return 0;
+    uint32_t occupied = board.ai | board.human;
+    uint32_t opponents = (piece.bits.side == SIDE_AI) ? board.human : board.ai;
 
     int dr[4], dc[4];
     uint8_t numDirs = 0;
@@ -156,9 +336,7 @@ uint8_t CheckersGame::generatePieceMoves(uint8_t index, Move *moves, bool forceC
         uint8_t destIndex = coordToIndex(destRow, destCol);
         if (midIndex == 255 || destIndex == 255)
             continue;
-        if (board[midIndex].bits.type != CP_EMPTY &&
-            board[midIndex].bits.side != piece.bits.side &&
-            board[destIndex].bits.type == CP_EMPTY) {
+        if ((opponents & (1UL << midIndex)) && !(occupied & (1UL << destIndex))) {
             moves[count].from = index;
             moves[count].to = destIndex;
             count++;
@@ -173,7 +351,7 @@ uint8_t CheckersGame::generatePieceMoves(uint8_t index, Move *moves, bool forceC
             if (!isValidCoord(destRow, destCol)) continue;
             uint8_t destIndex = coordToIndex(destRow, destCol);
             if (destIndex == 255) continue;
-            if (board[destIndex].bits.type == CP_EMPTY) {
+            if (!(occupied & (1UL << destIndex))) {
                 moves[count].from = index;
                 moves[count].to = destIndex;
                 count++;
@@ -186,8 +364,9 @@ uint8_t CheckersGame::generatePieceMoves(uint8_t index, Move *moves, bool forceC
 // Check whether any capture moves exist for the current side.
 bool CheckersGame::hasCaptureMoves() {
     Move tempMoves[12];
+    uint32_t own = (currentSide == SIDE_AI) ? board.ai : board.human;
     for (uint8_t i = 0; i < NUM_SQUARES; i++) {
-        if (board[i].bits.type != CP_EMPTY && board[i].bits.side == currentSide) {
+        if (own & (1UL << i)) {
             if (generatePieceMoves(i, tempMoves, true) > 0)
                 return true;
         }
@@ -199,8 +378,9 @@ bool CheckersGame::hasCaptureMoves() {
 uint8_t CheckersGame::generateMoves(Move *moves) {
     uint8_t count = 0;
     bool forceCapture = hasCaptureMoves();
+    uint32_t own = (currentSide == SIDE_AI) ? board.ai : board.human;
     for (uint8_t i = 0; i < NUM_SQUARES; i++) {
-        if (board[i].bits.type != CP_EMPTY && board[i].bits.side == currentSide) {
+        if (own & (1UL << i)) {
             count += generatePieceMoves(i, &moves[count], forceCapture);
         }
     }
@@ -229,76 +409,129 @@ bool CheckersGame::additionalCaptureAvailable(uint8_t index) {
     return (generatePieceMoves(index, temp, true) > 0);
 }
 
-// Apply a move: move the piece, remove any captured piece,
-// handle king promotion, and if a jump was made and further jumps exist, do not switch turn.
+// Apply a move and push its undo information.
 void CheckersGame::applyMove(const Move &m) {
-    MoveUndo undo;
-    memset(&undo, 0, sizeof(undo));
-    uint8_t fromRow, fromCol, toRow, toCol;
-    indexToCoord(m.from, fromRow, fromCol);
-    indexToCoord(m.to, toRow, toCol);
-    CheckerPiece movingPiece = board[m.from];
-    bool isJump = (abs((int)fromRow - (int)toRow) == 2);
-    undo.wasJump = isJump;
-    if (isJump) {
-        uint8_t capRow = (fromRow + toRow) / 2;
-        uint8_t capCol = (fromCol + toCol) / 2;
-        uint8_t capIndex = coordToIndex(capRow, capCol);
-        undo.capturedIndex = capIndex;
-        undo.capturedPieceRaw = board[capIndex].raw;
-        board[capIndex].raw = 0;
+    undoStack[undoStackIndex++ & (UNDO_STACK_SIZE - 1)] = movePiece(m);
+}
+
+// Apply a move without recording undo information; the engine restores
+// the saved CheckersState instead.
+void CheckersGame::makeMove(const Move &m) {
+    movePiece(m);
+}
+
+uint8_t CheckersGame::stateSize() {
+    return sizeof(CheckersState);
+}
+
+void *CheckersGame::stateData() {
+    return static_cast<CheckersState *>(this);
+}
+
+// Mix the bitboards, side to move and last move into a 32-bit key.
+bool CheckersGame::positionKey(uint32_t &key) {
+    uint32_t h = board.ai * 0x9E3779B1UL;
+    h = (h ^ (h >> 15)) + board.human * 0x85EBCA77UL;
+    h = (h ^ (h >> 13)) + board.kings * 0xC2B2AE3DUL;
+    h ^= (uint32_t)currentSide << 31;
+    if (lastMoveValid)
+        h ^= (((uint32_t)lastMove.from << 5) | lastMove.to) * 0x27D4EB2FUL;
+    key = h ^ (h >> 16);
+    return true;
+}
+
+// Move the piece on a board, remove any captured piece and handle king
+// promotion. Returns the undo information for the board.
+MoveUndo CheckersGame::moveOnBoard(const Move &m, CheckersBoard &b) {
+    MoveUndo undo = 0;
+    uint32_t fromBit = 1UL << m.from;
+    uint32_t toBit = 1UL << m.to;
+    bool aiMoving = (b.ai & fromBit) != 0;
+    uint32_t &own = aiMoving ? b.ai : b.human;
+    uint32_t &opponents = aiMoving ? b.human : b.ai;
+    // Move the piece (and its king flag).
+    own ^= fromBit | toBit;
+    if (b.kings & fromBit)
+        b.kings ^= fromBit | toBit;
+    uint8_t fromRow = m.from / 4;
+    uint8_t toRow = m.to / 4;
+    if (abs((int)fromRow - (int)toRow) == 2) {
+        uint32_t capBit = 1UL << jumpedIndex(m);
+        undo = UNDO_JUMP;
+        if (b.kings & capBit)
+            undo |= UNDO_CAPTURED_KING;
+        opponents &= ~capBit;
+        b.kings &= ~capBit;
     }
-    // Move the piece.
-    board[m.to] = movingPiece;
-    board[m.from].raw = 0;
     // Check for promotion.
-    uint8_t destRow, destCol;
-    indexToCoord(m.to, destRow, destCol);
-    if (movingPiece.bits.type == CP_MAN) {
-        if ((movingPiece.bits.side == SIDE_AI && destRow == 7) ||
-            (movingPiece.bits.side == SIDE_HUMAN && destRow == 0)) {
-            undo.promotionOccurred = true;
-            undo.previousPieceRaw = board[m.to].raw;
-            board[m.to].bits.type = CP_KING;
-        }
+    if (!(b.kings & toBit) && toRow == (aiMoving ? 7 : 0)) {
+        undo |= UNDO_PROMOTION;
+        b.kings |= toBit;
     }
+    return undo;
+}
+
+uint8_t CheckersGame::jumpedIndex(const Move &m) {
+    uint8_t fromRow, fromCol, toRow, toCol;
+    indexToCoord(m.from, fromRow, fromCol);
+    indexToCoord(m.to, toRow, toCol);
+    return coordToIndex((fromRow + toRow) / 2, (fromCol + toCol) / 2);
+}
+
+// Move the piece, and if a jump was made and further jumps exist,
+// do not switch turn.
+MoveUndo CheckersGame::movePiece(const Move &m) {
+    MoveUndo undo = moveOnBoard(m, board);
     // Decide whether to switch turn.
     bool switchTurn = true;
-    if (isJump && additionalCaptureAvailable(m.to))
+    if ((undo & UNDO_JUMP) && additionalCaptureAvailable(m.to))
         switchTurn = false;
-    undo.turnSwitched = switchTurn;
     if (switchTurn) {
+        undo |= UNDO_TURN_SWITCHED;
         currentSide = (currentSide == SIDE_AI ? SIDE_HUMAN : SIDE_AI);
-        // Update lastMove only when the turn switches.
+        // Update lastMove only when the turn switches, keeping the old one.
+        undo |= ((MoveUndo)(lastMove.from & 0x1F) << UNDO_LAST_FROM) | ((MoveUndo)(lastMove.to & 0x1F) << UNDO_LAST_TO);
+        if (lastMoveValid)
+            undo |= UNDO_LAST_VALID;
         lastMove = m;
         lastMoveValid = true;
     }
-    // Push undo info.
-    undoStack[undoStackIndex++] = undo;
     // Update board history: record the new board hash.
     if (historySize < sizeof(boardHistory) / sizeof(boardHistory[0])) {
         boardHistory[historySize++] = computeBoardHash();
+        undo |= UNDO_HISTORY;
     }
+    return undo;
 }
 
 // Undo a move: reverse piece movement, restore captured piece (if any),
-// revert promotion if occurred, and restore the turn.
+// revert promotion if occurred, and restore the turn, last move and history.
 void CheckersGame::undoMove(const Move &m) {
-    if (undoStackIndex == 0) return;
-    MoveUndo undo = undoStack[--undoStackIndex];
-    board[m.from] = board[m.to];
-    board[m.to].raw = 0;
-    if (undo.promotionOccurred) {
-        board[m.from].raw = undo.previousPieceRaw;
+    MoveUndo undo = undoStack[--undoStackIndex & (UNDO_STACK_SIZE - 1)];
+    uint32_t fromBit = 1UL << m.from;
+    uint32_t toBit = 1UL << m.to;
+    bool aiMoving = (board.ai & toBit) != 0;
+    uint32_t &own = aiMoving ? board.ai : board.human;
+    uint32_t &opponents = aiMoving ? board.human : board.ai;
+    own ^= fromBit | toBit;
+    if (board.kings & toBit)
+        board.kings ^= fromBit | toBit;
+    if (undo & UNDO_PROMOTION)
+        board.kings &= ~fromBit;
+    if (undo & UNDO_JUMP) {
+        uint32_t capBit = 1UL << jumpedIndex(m);
+        opponents |= capBit;
+        if (undo & UNDO_CAPTURED_KING)
+            board.kings |= capBit;
     }
-    if (undo.wasJump) {
-        board[undo.capturedIndex].raw = undo.capturedPieceRaw;
-    }
-    if (undo.turnSwitched) {
+    if (undo & UNDO_TURN_SWITCHED) {
         currentSide = (currentSide == SIDE_AI ? SIDE_HUMAN : SIDE_AI);
+        lastMove.from = (undo >> UNDO_LAST_FROM) & 0x1F;
+        lastMove.to = (undo >> UNDO_LAST_TO) & 0x1F;
+        lastMoveValid = (undo & UNDO_LAST_VALID) != 0;
     }
-    // Remove the last board hash from the history.
-    if (historySize > 0)
+    // Remove the board hash the move added to the history.
+    if (undo & UNDO_HISTORY)
         historySize--;
 }
 
@@ -306,14 +539,7 @@ void CheckersGame::undoMove(const Move &m) {
 bool CheckersGame::isGameOver() {
     Move temp[32];
     uint8_t count = generateMoves(temp);
-    bool hasAI = false, hasHuman = false;
-    for (uint8_t i = 0; i < NUM_SQUARES; i++) {
-        if (board[i].bits.type != CP_EMPTY) {
-            if (board[i].bits.side == SIDE_AI) hasAI = true;
-            else hasHuman = true;
-        }
-    }
-    return (count == 0 || !hasAI || !hasHuman);
+    return (count == 0 || board.ai == 0 || board.human == 0);
 }
 
 // Return +1 if AI's turn, -1 if Human's.
@@ -338,11 +564,12 @@ void CheckersGame::printBoard() {
         uint8_t row, col;
         indexToCoord(i, row, col);
         char symbol = '.';
-        if (board[i].bits.type != CP_EMPTY) {
-            if (board[i].bits.side == SIDE_AI)
-                symbol = (board[i].bits.type == CP_MAN) ? 'X' : 'K';
+        CheckerPiece piece = pieceAt(i);
+        if (piece.bits.type != CP_EMPTY) {
+            if (piece.bits.side == SIDE_AI)
+                symbol = (piece.bits.type == CP_MAN) ? 'X' : 'K';
             else
-                symbol = (board[i].bits.type == CP_MAN) ? 'O' : 'Q';
+                symbol = (piece.bits.type == CP_MAN) ? 'O' : 'Q';
         }
         disp[row][col] = symbol;
     }
@@ -23,6 +23,7 @@ enum CheckersSide {
 };
 
 /// A checkers piece stored in 1 byte via bitfields.
+/// Used when reading single squares; the board itself is held as bitboards.
 struct CheckerPiece {
     union {
         uint8_t raw;
@@ -37,35 +38,60 @@ struct CheckerPiece {
 /// We use a 32–square board (only the playable dark squares).
 #define NUM_SQUARES 32
 
-/// Information to undo a move.
-struct MoveUndo {
-    bool wasJump;
-    uint8_t capturedIndex;    // index of captured piece (if jump)
-    uint8_t capturedPieceRaw; // raw value of captured piece
-    bool promotionOccurred;
-    uint8_t previousPieceRaw; // piece value before promotion
-    bool turnSwitched;        // whether the turn was switched after the move
+/// The board packed as bitboards: bit i stands for playable square i (0–31).
+struct CheckersBoard {
+    uint32_t ai;     // Squares holding an AI piece
+    uint32_t human;  // Squares holding a Human piece
+    uint32_t kings;  // Squares holding a king of either side
 };
 
-/// CheckersGame implements GameInterface for standard American checkers.
-class CheckersGame : public GameInterface {
-public:
-    CheckerPiece board[NUM_SQUARES];  // 32 playable squares.
+/// Size of the undo stack. It is used as a ring (must be a power of two)
+/// so the real game can go on indefinitely; only the most recent entries,
+/// which the search needs, are kept.
+#define UNDO_STACK_SIZE 64
+
+/// Information to undo a move, packed into 2 bytes.
+/// The captured piece always belongs to the side that did not move, on
+/// the square the jump passed over. A move that switches the turn replaces
+/// lastMove, so the record keeps the previous one (both squares, even when
+/// it was not valid).
+typedef uint16_t MoveUndo;
+#define UNDO_JUMP           0x0001  // the move was a jump
+#define UNDO_CAPTURED_KING  0x0002  // the captured piece was a king
+#define UNDO_PROMOTION      0x0004  // the moving man was promoted to king
+#define UNDO_TURN_SWITCHED  0x0008  // the turn was switched after the move
+#define UNDO_HISTORY        0x0010  // the board was added to boardHistory
+#define UNDO_LAST_VALID     0x0020  // the previous lastMove was valid
+#define UNDO_LAST_FROM      6       // shift of the previous lastMove.from (5 bits)
+#define UNDO_LAST_TO        11      // shift of the previous lastMove.to (5 bits)
+
+/// Everything that changes when a move is made, kept in one trivially
+/// copyable struct so the engine can search with copy-make.
+/// The hashes in boardHistory above historySize are scratch space.
+struct CheckersState {
+    CheckersBoard board;              // 32 playable squares.
     uint8_t currentSide;              // SIDE_AI or SIDE_HUMAN indicating whose turn it is.
-    MoveUndo undoStack[64];           // Fixed–size undo stack for minimax recursion.
-    uint8_t undoStackIndex;           // Stack pointer.
     
     // Store last move to help avoid immediate reversal moves.
     Move lastMove;
     bool lastMoveValid;
     
+    uint8_t historySize;              // Number of entries in boardHistory
+};
+
+/// CheckersGame implements GameInterface for standard American checkers.
+class CheckersGame : public GameInterface, public CheckersState {
+public:
+    MoveUndo undoStack[UNDO_STACK_SIZE]; // Fixed–size undo ring for the minimax search.
+    uint8_t undoStackIndex;           // Stack pointer (wraps around the ring).
+    
     // --- New: Board history for repetition detection ---
     uint16_t boardHistory[32]; // Simple history (one hash per applied move)
-    uint8_t historySize;       // Number of entries in boardHistory
     
     CheckersGame();
     
     // Evaluate the board: a positive score favors AI, negative favors Human.
+    // Returns +/-SCORE_WIN once a side has no pieces left.
     int evaluateBoard() override;
     
     // Generate legal moves for the current position.
@@ -78,9 +104,26 @@ public:
     // Undo the move, restoring captured pieces and previous turn if needed.
     void undoMove(const Move &m) override;
     
+    // Copy-make support: the CheckersState part of the game is the whole state.
+    uint8_t stateSize() override;
+    void *stateData() override;
+    
+    // Apply a move without recording undo information (copy-make search).
+    void makeMove(const Move &m) override;
+    
+    // Hash of the board, side to move and last move (which limits reversals).
+    bool positionKey(uint32_t &key) override;
+    
     // Returns true if the game is over (no legal moves or one side has no pieces).
     bool isGameOver() override;
     
+#if !defined(ARDUINO)
+    // Score the positions after several moves in one call (frontier batching).
+    // Host builds score the boards of the batch together: with SSE2 on any
+    // x86-64 host, or AVX2 when the compiler targets it (-mavx2, -march=native).
+    bool evaluateMoves(const Move *moves, uint8_t count, int *scores) override;
+#endif
+    
     // Returns +1 if it is AI's turn, -1 if Human's.
     int currentPlayer() override;
     
@@ -90,6 +133,12 @@ public:
     // Print the board to Serial.
     void printBoard();
     
+    // Read the piece on a board index (0–31).
+    CheckerPiece pieceAt(uint8_t index) const;
+    
+    // Helper: Penalty for a board that has already occurred in the history.
+    int repetitionPenalty();
+    
     // Helper: Check if any capture moves exist for the current side.
     bool hasCaptureMoves();
     
@@ -110,6 +159,19 @@ public:
     bool additionalCaptureAvailable(uint8_t index);
     
 private:
+    // Make the move on the board and return the information needed to undo it.
+    MoveUndo movePiece(const Move &m);
+    
+    // Move, capture and promote on a board only (no turn or history update).
+    MoveUndo moveOnBoard(const Move &m, CheckersBoard &b);
+
+    // The square a jump passes over.
+    uint8_t jumpedIndex(const Move &m);
+    
+    // Repetition penalty for a board hash that occurs extra more times
+    // than the history shows.
+    int repetitionPenalty(uint16_t hash, uint8_t extra);
+    
     // Compute a simple hash of the board state.
     uint16_t computeBoardHash();
 };
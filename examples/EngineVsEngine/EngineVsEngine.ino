@@ -1,9 +1,26 @@
 #include <Arduino.h>
 #include "TicTacToeGame.h"
 #include "MinimaxAI.h"
+#include "TicTacToeSolver.h"
 
+// Player 1 (X) plays from the compile-time table, Player 2 (O) searches.
 TicTacToeGame game;
+TicTacToeSolver solver(game);
+
+// The engine reserves a search frame of MAX_MOVES moves (32 by default, for
+// checkers) for each of MINIMAX_MAX_PLY plies (10 by default): about 790
+// bytes on AVR. Tic-Tac-Toe never has more than 9 moves or 9 plies, so
+// build with -DMAX_MOVES=9 -DMINIMAX_MAX_PLY=9 to bring that down to about
+// 300 bytes, for example with arduino-cli:
+//   arduino-cli compile --build-property "compiler.cpp.extra_flags=-DMAX_MOVES=9 -DMINIMAX_MAX_PLY=9"
+// The flags must reach the library as well as the sketch, so do not #define
+// them here.
 MinimaxAI ai(game, 9);  // Use full-depth search for Tic-Tac-Toe
+static_assert(MAX_MOVES >= 9, "MAX_MOVES is below the 9 moves of Tic-Tac-Toe");
+static_assert(MINIMAX_MAX_PLY >= 9, "MINIMAX_MAX_PLY is below the sketch's full-depth search");
+
+// One saved state per search ply so the engine can use copy-make.
+TicTacToeState searchStates[9];
 
 // Statistics counters.
 uint16_t winsPlayer1 = 0;
@@ -15,7 +32,7 @@ void printBoard() {
   const char symbols[3] = { ' ', 'X', 'O' };
   Serial.println(F("Board:"));
   for (int i = 0; i < 9; i++) {
-    Serial.print(symbols[game.board[i]]);
+    Serial.print(symbols[game.cell(i)]);
     if ((i % 3) == 2)
       Serial.println();
     else
@@ -43,7 +60,11 @@ void setup() {
   randomSeed(analogRead(0));
   
   Serial.println(F("Engine vs Engine Tic-Tac-Toe:"));
+  Serial.print(F("Engine search stack: "));
+  Serial.print(MinimaxAI::SEARCH_STACK_BYTES);
+  Serial.println(F(" bytes"));
   game.reset_game();
+  ai.setStateBuffer(searchStates, sizeof(searchStates));
   printBoard();
 }
 
@@ -63,9 +84,23 @@ void loop() {
     delay(500);
     printBoard();
   } else {
-    Move move = ai.findBestMove();
-    Serial.print(F("Engine plays at position "));
-    Serial.println(move.to + 1);
+    Move move;
+    unsigned long start = micros();
+    if (game.current == AI) {
+      // Open with a random optimal move so that the games differ.
+      if (!game.optimalOpeningMove(move)) {
+        move = solver.findBestMove();
+      }
+      Serial.print(F("Table plays at position "));
+    } else {
+      move = ai.findBestMove();
+      Serial.print(F("Search plays at position "));
+    }
+    unsigned long elapsed = micros() - start;
+    Serial.print(move.to + 1);
+    Serial.print(F(" ("));
+    Serial.print(elapsed);
+    Serial.println(F(" us)"));
     game.applyMove(move);
     printBoard();
 //    delay(500);
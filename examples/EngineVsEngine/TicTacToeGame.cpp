@@ -1,69 +1,114 @@
 #include "TicTacToeGame.h"
-#include <string.h>
 #include <avr/pgmspace.h>
 
 // Declare the optimal moves array as a file-scope constant in PROGMEM.
 // These positions are the center and the four corners.
 static const uint8_t optimalMoves[5] PROGMEM = {0, 2, 4, 6, 8};
 
+// All nine cells set.
+static const uint16_t FULL_BOARD = 0x1FF;
+
+// Where each cell goes under the 8 symmetries of the board. Transforms 0-3
+// rotate by 0-3 quarter turns; 4-7 mirror left-right and then rotate.
+static const uint8_t symmetryCells[8][9] PROGMEM = {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8},
+    {2, 5, 8, 1, 4, 7, 0, 3, 6},
+    {8, 7, 6, 5, 4, 3, 2, 1, 0},
+    {6, 3, 0, 7, 4, 1, 8, 5, 2},
+    {2, 1, 0, 5, 4, 3, 8, 7, 6},
+    {8, 5, 2, 7, 4, 1, 6, 3, 0},
+    {6, 7, 8, 3, 4, 5, 0, 1, 2},
+    {0, 3, 6, 1, 4, 7, 2, 5, 8}
+};
+
+// The two masks packed side by side (AI in bits 0-8, Human in bits 9-17),
+// so one shift moves a cell on both boards.
+#define BOTH(mask) ((uint32_t)(mask) | ((uint32_t)(mask) << 9))
+
+// Rotate both boards a quarter turn (transform 1), grouping cells that
+// move by the same distance.
+static inline uint32_t rotateBoards(uint32_t b) {
+    return ((b & BOTH(0x021)) << 2) | ((b & BOTH(0x002)) << 4) | ((b & BOTH(0x004)) << 6) |
+           ((b & BOTH(0x108)) >> 2) | ((b & BOTH(0x080)) >> 4) | ((b & BOTH(0x040)) >> 6) |
+           (b & BOTH(0x010));
+}
+
+// Mirror both boards left-right (transform 4).
+static inline uint32_t mirrorBoards(uint32_t b) {
+    return ((b & BOTH(0x049)) << 2) | ((b & BOTH(0x124)) >> 2) | (b & BOTH(0x092));
+}
+#undef BOTH
+
+// Return true if the mask contains one of the eight winning lines.
+static inline bool hasLine(uint16_t m) {
+    return ((m & 0x007) == 0x007) || ((m & 0x038) == 0x038) || ((m & 0x1C0) == 0x1C0) ||  // Rows.
+           ((m & 0x049) == 0x049) || ((m & 0x092) == 0x092) || ((m & 0x124) == 0x124) ||  // Columns.
+           ((m & 0x111) == 0x111) || ((m & 0x054) == 0x054);                              // Diagonals.
+}
+
+// Heuristic value of a line holding `ai` AI marks and `human` Human marks.
+// Only lines that are not contested score anything.
+static constexpr int8_t lineValue(uint8_t ai, uint8_t human) {
+    return (human == 0) ? (ai == 2 ? 5 : (ai == 1 ? 1 : 0))      // AI nearly wins / has a start.
+         : (ai == 0)    ? (human == 2 ? -5 : (human == 1 ? -1 : 0))  // Human nearly wins => must block.
+         : 0;
+}
+
+static constexpr uint8_t bitCount3(uint8_t v) {
+    return (v & 1) + ((v >> 1) & 1) + ((v >> 2) & 1);
+}
+
+// Line score table indexed by (aiBits << 3) | humanBits, where each 3-bit field
+// holds that side's marks on the line. Generated at compile time into PROGMEM.
+#define LINE_SCORE(i)  lineValue(bitCount3((i) >> 3), bitCount3((i) & 7))
+#define LINE_SCORE8(i) LINE_SCORE(i), LINE_SCORE(i + 1), LINE_SCORE(i + 2), LINE_SCORE(i + 3), \
+                       LINE_SCORE(i + 4), LINE_SCORE(i + 5), LINE_SCORE(i + 6), LINE_SCORE(i + 7)
+static const int8_t lineScores[64] PROGMEM = {
+    LINE_SCORE8(0),  LINE_SCORE8(8),  LINE_SCORE8(16), LINE_SCORE8(24),
+    LINE_SCORE8(32), LINE_SCORE8(40), LINE_SCORE8(48), LINE_SCORE8(56)
+};
+#undef LINE_SCORE8
+#undef LINE_SCORE
+
+// Gather the three cells A, B, C of a line from both masks into a table index.
+template <uint8_t A, uint8_t B, uint8_t C>
+static inline int8_t scoreLine(uint16_t ai, uint16_t human) {
+    uint8_t index = (((ai >> A) & 1) << 5) | (((ai >> B) & 1) << 4) | (((ai >> C) & 1) << 3) |
+                    (((human >> A) & 1) << 2) | (((human >> B) & 1) << 1) | ((human >> C) & 1);
+    return (int8_t)pgm_read_byte(&lineScores[index]);
+}
+
 TicTacToeGame::TicTacToeGame() {
     reset_game();
 }
 
 int TicTacToeGame::evaluateBoard() {
     // Terminal states have highest priority.
-    if (isWinner(1)) return +10;  // AI wins (mark 1)
-    if (isWinner(2)) return -10;  // Human wins (mark 2)
-    
+    if (hasLine(aiMask)) return +SCORE_WIN;     // AI wins (mark 1)
+    if (hasLine(humanMask)) return -SCORE_WIN;  // Human wins (mark 2)
+
     // For non-terminal states, use a heuristic evaluation.
     int score = 0;
-    
-    // Lambda function to evaluate one line given indices.
-    auto evaluateLine = [this](uint8_t idx1, uint8_t idx2, uint8_t idx3) -> int {
-        int scoreLine = 0;
-        int countAI = 0, countHuman = 0;
-        uint8_t cells[3] = { board[idx1], board[idx2], board[idx3] };
-        for (int i = 0; i < 3; i++) {
-            if (cells[i] == 1)
-                countAI++;
-            else if (cells[i] == 2)
-                countHuman++;
-        }
-        // Only consider lines that are not contested.
-        if (countAI > 0 && countHuman == 0) {
-            if (countAI == 2)
-                scoreLine = 5;   // AI nearly wins.
-            else if (countAI == 1)
-                scoreLine = 1;
-        }
-        else if (countHuman > 0 && countAI == 0) {
-            if (countHuman == 2)
-                scoreLine = -5;  // Human nearly wins => must block.
-            else if (countHuman == 1)
-                scoreLine = -1;
-        }
-        return scoreLine;
-    };
-
     // Evaluate rows.
-    score += evaluateLine(0, 1, 2);
-    score += evaluateLine(3, 4, 5);
-    score += evaluateLine(6, 7, 8);
+    score += scoreLine<0, 1, 2>(aiMask, humanMask);
+    score += scoreLine<3, 4, 5>(aiMask, humanMask);
+    score += scoreLine<6, 7, 8>(aiMask, humanMask);
     // Evaluate columns.
-    score += evaluateLine(0, 3, 6);
-    score += evaluateLine(1, 4, 7);
-    score += evaluateLine(2, 5, 8);
+    score += scoreLine<0, 3, 6>(aiMask, humanMask);
+    score += scoreLine<1, 4, 7>(aiMask, humanMask);
+    score += scoreLine<2, 5, 8>(aiMask, humanMask);
     // Evaluate diagonals.
-    score += evaluateLine(0, 4, 8);
-    score += evaluateLine(2, 4, 6);
-    
+    score += scoreLine<0, 4, 8>(aiMask, humanMask);
+    score += scoreLine<2, 4, 6>(aiMask, humanMask);
+
     return score;
 }
 
 uint8_t TicTacToeGame::generateMoves(Move *moves) {
     uint8_t count = 0;
-    for (uint8_t i = 0; i < 9; i++) {
-        if (board[i] == 0) {
+    uint16_t empty = ~(aiMask | humanMask) & FULL_BOARD;
+    for (uint8_t i = 0; empty != 0; i++, empty >>= 1) {
+        if (empty & 1) {
             moves[count].from = i;  // Not used, but set for clarity.
             moves[count].to = i;
             count++;
@@ -73,32 +118,92 @@ uint8_t TicTacToeGame::generateMoves(Move *moves) {
 }
 
 void TicTacToeGame::applyMove(const Move &m) {
-    uint8_t pos = m.to;
     // Ensure pos is within bounds.
-    if (pos < 9) {
-        board[pos] = (current == AI ? 1 : 2);
+    if (m.to < 9) {
+        uint16_t bit = (uint16_t)1 << m.to;
+        if (current == AI)
+            aiMask |= bit;
+        else
+            humanMask |= bit;
     }
     // Switch turn.
     current = (current == AI ? HUMAN : AI);
 }
 
 void TicTacToeGame::undoMove(const Move &m) {
-    uint8_t pos = m.to;
-    if (pos < 9) {
-        board[pos] = 0;
+    if (m.to < 9) {
+        uint16_t keep = ~((uint16_t)1 << m.to);
+        aiMask &= keep;
+        humanMask &= keep;
     }
     // Switch turn back.
     current = (current == AI ? HUMAN : AI);
 }
 
 bool TicTacToeGame::isGameOver() {
-    return isWinner(1) || isWinner(2) || isBoardFull();
+    return hasLine(aiMask) || hasLine(humanMask) || isBoardFull();
 }
 
 int TicTacToeGame::currentPlayer() {
     return (current == AI ? 1 : -1);
 }
 
+uint8_t TicTacToeGame::stateSize() {
+    return sizeof(TicTacToeState);
+}
+
+void *TicTacToeGame::stateData() {
+    return static_cast<TicTacToeState *>(this);
+}
+
+bool TicTacToeGame::positionKey(uint32_t &key) {
+    key = aiMask | ((uint32_t)humanMask << 9) | ((uint32_t)current << 18);
+    return true;
+}
+
+bool TicTacToeGame::canonicalKey(uint32_t &key, uint8_t &transform) {
+    uint32_t boards = aiMask | ((uint32_t)humanMask << 9);
+    key = boards;
+    transform = 0;
+    for (uint8_t t = 1; t < 8; t++) {
+        boards = (t == 4) ? mirrorBoards(aiMask | ((uint32_t)humanMask << 9)) : rotateBoards(boards);
+        if (boards < key) {
+            key = boards;
+            transform = t;
+        }
+    }
+    key |= (uint32_t)current << 18;
+    return true;
+}
+
+bool TicTacToeGame::isSymmetric() {
+    uint32_t boards = aiMask | ((uint32_t)humanMask << 9);
+    uint32_t image = boards;
+    for (uint8_t t = 1; t < 8; t++) {
+        image = (t == 4) ? mirrorBoards(boards) : rotateBoards(image);
+        if (image == boards) {
+            return true;
+        }
+    }
+    return false;
+}
+
+Move TicTacToeGame::transformMove(const Move &m, uint8_t transform, bool inverse) {
+    if (m.to >= 9) {
+        return m;
+    }
+    if (!inverse) {
+        uint8_t to = pgm_read_byte(&symmetryCells[transform][m.to]);
+        return Move{to, to};
+    }
+    // Find the cell that the transform moves onto m.to.
+    uint8_t from = 0;
+    while (pgm_read_byte(&symmetryCells[transform][from]) != m.to) {
+        from++;
+    }
+    return Move{from, from};
+}
+
 uint32_t get_random_seed() {
     uint32_t seed = 0;
     int pins[] = { A0, A1, A2, A3 };
@@ -116,43 +221,27 @@ uint32_t get_random_seed() {
 void TicTacToeGame::reset_game() {
     randomSeed(get_random_seed());
 
-    memset(board, 0, sizeof(board));
+    aiMask = 0;
+    humanMask = 0;
     current = AI;  // You may alternate starting players if desired.
 }
 
+uint8_t TicTacToeGame::cell(uint8_t i) const {
+    if ((aiMask >> i) & 1) return 1;
+    if ((humanMask >> i) & 1) return 2;
+    return 0;
+}
+
 bool TicTacToeGame::isWinner(uint8_t mark) {
-    // Store winning combinations in PROGMEM to save RAM.
-    const uint8_t wins[8][3] PROGMEM = {
-        {0, 1, 2}, {3, 4, 5}, {6, 7, 8},   // Rows.
-        {0, 3, 6}, {1, 4, 7}, {2, 5, 8},   // Columns.
-        {0, 4, 8}, {2, 4, 6}              // Diagonals.
-    };
-
-    for (uint8_t i = 0; i < 8; i++) {
-        uint8_t a = pgm_read_byte(&(wins[i][0]));
-        uint8_t b = pgm_read_byte(&(wins[i][1]));
-        uint8_t c = pgm_read_byte(&(wins[i][2]));
-        if (board[a] == mark && board[b] == mark && board[c] == mark) {
-            return true;
-        }
-    }
-    return false;
+    return hasLine(mark == 1 ? aiMask : humanMask);
 }
 
 bool TicTacToeGame::isBoardFull() {
-    for (uint8_t i = 0; i < 9; i++) {
-        if (board[i] == 0)
-            return false;
-    }
-    return true;
+    return (aiMask | humanMask) == FULL_BOARD;
 }
 
 bool TicTacToeGame::isBoardEmpty() {
-    for (uint8_t i = 0; i < 9; i++) {
-        if (board[i] != 0)
-            return false;
-    }
-    return true;
+    return (aiMask | humanMask) == 0;
 }
 
 bool TicTacToeGame::optimalOpeningMove(Move &move) {
@@ -168,3 +257,4 @@ bool TicTacToeGame::optimalOpeningMove(Move &move) {
     }
     return false;
 }
+
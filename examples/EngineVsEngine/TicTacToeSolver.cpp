@@ -0,0 +1,193 @@
+#include "TicTacToeSolver.h"
+#include <avr/pgmspace.h>
+
+// The game is solved by the compiler. Positions are seen from the side to
+// move: `Me` holds its marks and `You` the opponent's, so one table serves
+// both sides whoever started the game. Each position is a class template
+// instance, which the compiler creates only once however often it is
+// reached, so the whole game tree costs a few thousand instantiations.
+
+static constexpr uint16_t SOLVER_FULL = 0x1FF;
+
+static constexpr bool solverLine(uint16_t m) {
+    return ((m & 0x007) == 0x007) || ((m & 0x038) == 0x038) || ((m & 0x1C0) == 0x1C0) ||
+           ((m & 0x049) == 0x049) || ((m & 0x092) == 0x092) || ((m & 0x124) == 0x124) ||
+           ((m & 0x111) == 0x111) || ((m & 0x054) == 0x054);
+}
+
+static constexpr uint8_t solverMarks(uint16_t m) {
+    return m == 0 ? 0 : (m & 1) + solverMarks(m >> 1);
+}
+
+static constexpr bool solverOver(uint16_t me, uint16_t you) {
+    return solverLine(you) || (me | you) == SOLVER_FULL;
+}
+
+// The first empty cell from `cell` on, or 9 if there is none.
+static constexpr uint8_t solverNextEmpty(uint16_t taken, uint8_t cell) {
+    return (cell >= 9 || ((taken >> cell) & 1) == 0) ? cell : solverNextEmpty(taken, cell + 1);
+}
+
+// Negamax score for the side to move: 0 for a draw, otherwise +/-(10 - marks
+// on the board when the game ends), so faster wins score higher.
+template <uint16_t Me, uint16_t You, bool Over = solverOver(Me, You)>
+struct SolverValue;
+
+// The best score and the first cell reaching it, over the empty cells from
+// Cell on.
+template <uint16_t Me, uint16_t You, uint8_t Cell = solverNextEmpty(Me | You, 0)>
+struct SolverBest {
+    typedef SolverBest<Me, You, solverNextEmpty(Me | You, Cell + 1)> Rest;
+    static constexpr int8_t here = -SolverValue<You, Me | (1 << Cell)>::score;
+    static constexpr int8_t score = (here >= Rest::score) ? here : Rest::score;
+    static constexpr uint8_t cell = (here >= Rest::score) ? Cell : Rest::cell;
+};
+
+template <uint16_t Me, uint16_t You>
+struct SolverBest<Me, You, 9> {
+    static constexpr int8_t score = -11;
+    static constexpr uint8_t cell = 0xF;
+};
+
+template <uint16_t Me, uint16_t You>
+struct SolverValue<Me, You, true> {
+    static constexpr int8_t score = solverLine(You) ? (int8_t)(solverMarks(Me | You) - 10) : 0;
+};
+
+template <uint16_t Me, uint16_t You>
+struct SolverValue<Me, You, false> {
+    static constexpr int8_t score = SolverBest<Me, You>::score;
+};
+
+// Cells of a base-3 board index holding the given digit (cell i is digit i:
+// 0 empty, 1 side to move, 2 opponent).
+static constexpr uint16_t solverCells(uint16_t index, uint8_t digit, uint8_t cell) {
+    return cell == 9 ? 0
+         : ((index % 3 == digit) ? (1 << cell) : 0) | solverCells(index / 3, digit, cell + 1);
+}
+
+// A position a game can reach with moves left: the side to move has as many
+// marks as the opponent or one fewer, and nobody has won.
+static constexpr bool solverPlayable(uint16_t me, uint16_t you) {
+    return (solverMarks(me) == solverMarks(you) || solverMarks(me) + 1 == solverMarks(you)) &&
+           !solverLine(me) && !solverOver(me, you);
+}
+
+#define SOLVED_POSITIONS 19683
+
+// The best cell for a board index, or 0xF if there is nothing to play.
+template <uint16_t Index, uint16_t Me = solverCells(Index, 1, 0), uint16_t You = solverCells(Index, 2, 0),
+          bool Playable = (Index < SOLVED_POSITIONS) && solverPlayable(Me, You)>
+struct SolvedMove {
+    static constexpr uint8_t cell = 0xF;
+};
+
+template <uint16_t Index, uint16_t Me, uint16_t You>
+struct SolvedMove<Index, Me, You, true> {
+    static constexpr uint8_t cell = SolverBest<Me, You>::cell;
+};
+
+// Two positions per byte, low nibble first.
+#define SOLVED_PAIR(p) (uint8_t)(SolvedMove<2 * (p)>::cell | (SolvedMove<2 * (p) + 1>::cell << 4))
+#define SOLVED_PAIR10(p) \
+    SOLVED_PAIR(p), SOLVED_PAIR((p) + 1), SOLVED_PAIR((p) + 2), SOLVED_PAIR((p) + 3), SOLVED_PAIR((p) + 4), \
+    SOLVED_PAIR((p) + 5), SOLVED_PAIR((p) + 6), SOLVED_PAIR((p) + 7), SOLVED_PAIR((p) + 8), SOLVED_PAIR((p) + 9)
+#define SOLVED_PAIR100(p) \
+    SOLVED_PAIR10(p), SOLVED_PAIR10((p) + 10), SOLVED_PAIR10((p) + 20), SOLVED_PAIR10((p) + 30), \
+    SOLVED_PAIR10((p) + 40), SOLVED_PAIR10((p) + 50), SOLVED_PAIR10((p) + 60), SOLVED_PAIR10((p) + 70), \
+    SOLVED_PAIR10((p) + 80), SOLVED_PAIR10((p) + 90)
+#define SOLVED_PAIR1000(p) \
+    SOLVED_PAIR100(p), SOLVED_PAIR100((p) + 100), SOLVED_PAIR100((p) + 200), SOLVED_PAIR100((p) + 300), \
+    SOLVED_PAIR100((p) + 400), SOLVED_PAIR100((p) + 500), SOLVED_PAIR100((p) + 600), SOLVED_PAIR100((p) + 700), \
+    SOLVED_PAIR100((p) + 800), SOLVED_PAIR100((p) + 900)
+
+// The best cell of every position: 9842 bytes.
+static const uint8_t perfectMoves[(SOLVED_POSITIONS + 1) / 2] PROGMEM = {
+    SOLVED_PAIR1000(0), SOLVED_PAIR1000(1000), SOLVED_PAIR1000(2000), SOLVED_PAIR1000(3000),
+    SOLVED_PAIR1000(4000), SOLVED_PAIR1000(5000), SOLVED_PAIR1000(6000), SOLVED_PAIR1000(7000),
+    SOLVED_PAIR1000(8000), SOLVED_PAIR100(9000), SOLVED_PAIR100(9100), SOLVED_PAIR100(9200),
+    SOLVED_PAIR100(9300), SOLVED_PAIR100(9400), SOLVED_PAIR100(9500), SOLVED_PAIR100(9600),
+    SOLVED_PAIR100(9700), SOLVED_PAIR10(9800), SOLVED_PAIR10(9810), SOLVED_PAIR10(9820),
+    SOLVED_PAIR10(9830), SOLVED_PAIR(9840), SOLVED_PAIR(9841)
+};
+
+#undef SOLVED_PAIR1000
+#undef SOLVED_PAIR100
+#undef SOLVED_PAIR10
+#undef SOLVED_PAIR
+
+// Results for the side to move.
+#define SOLVED_DRAW 0
+#define SOLVED_WIN  1
+#define SOLVED_LOSS 2
+
+// The best cell for the side to move, or 0xF if the game is over.
+static uint8_t lookup(uint16_t me, uint16_t you) {
+    uint16_t index = 0;
+    for (int8_t cell = 8; cell >= 0; cell--) {
+        index = index * 3 + (((me >> cell) & 1) ? 1 : (((you >> cell) & 1) ? 2 : 0));
+    }
+    uint8_t pair = pgm_read_byte(&perfectMoves[index >> 1]);
+    return (index & 1) ? (pair >> 4) : (pair & 0xF);
+}
+
+// The result for the side to move with perfect play, found by following
+// the stored best moves to the end of the game (at most 9 lookups).
+static uint8_t outcome(uint16_t me, uint16_t you) {
+    bool swapped = false;
+    while (!solverOver(me, you)) {
+        uint16_t next = me | ((uint16_t)1 << lookup(me, you));
+        me = you;
+        you = next;
+        swapped = !swapped;
+    }
+    if (!solverLine(you)) {
+        return SOLVED_DRAW;
+    }
+    return swapped ? SOLVED_WIN : SOLVED_LOSS;
+}
+
+TicTacToeSolver::TicTacToeSolver(TicTacToeGame &gameRef)
+    : game(&gameRef) {
+}
+
+Move TicTacToeSolver::findBestMove() {
+    uint16_t me = (game->current == AI) ? game->aiMask : game->humanMask;
+    uint16_t you = (game->current == AI) ? game->humanMask : game->aiMask;
+    if (solverOver(me, you) || solverLine(me)) {
+        return {0, 0};
+    }
+    uint8_t cell = lookup(me, you);
+    return {cell, cell};
+}
+
+uint16_t TicTacToeSolver::optimalMoves() {
+    uint16_t me = (game->current == AI) ? game->aiMask : game->humanMask;
+    uint16_t you = (game->current == AI) ? game->humanMask : game->aiMask;
+    if (solverOver(me, you) || solverLine(me)) {
+        return 0;
+    }
+    // A move is optimal if it leaves the opponent with the opposite result.
+    uint8_t value = outcome(me, you);
+    uint8_t reply = (value == SOLVED_WIN) ? SOLVED_LOSS : (value == SOLVED_LOSS ? SOLVED_WIN : SOLVED_DRAW);
+    uint16_t mask = 0;
+    for (uint8_t cell = 0; cell < 9; cell++) {
+        uint16_t bit = (uint16_t)1 << cell;
+        if (((me | you) & bit) == 0 && outcome(you, me | bit) == reply) {
+            mask |= bit;
+        }
+    }
+    return mask;
+}
+
+Score TicTacToeSolver::getScore() {
+    uint16_t me = (game->current == AI) ? game->aiMask : game->humanMask;
+    uint16_t you = (game->current == AI) ? game->humanMask : game->aiMask;
+    if (solverLine(me)) {
+        // The side to move won on an earlier move.
+        return (game->current == AI) ? SCORE_WIN : -SCORE_WIN;
+    }
+    uint8_t value = outcome(me, you);
+    Score score = (value == SOLVED_WIN) ? SCORE_WIN : (value == SOLVED_LOSS ? -SCORE_WIN : 0);
+    return (game->current == AI) ? score : -score;
+}
@@ -0,0 +1,28 @@
+#ifndef TIC_TAC_TOE_SOLVER_H
+#define TIC_TAC_TOE_SOLVER_H
+
+#include "TicTacToeGame.h"
+
+// Perfect play for TicTacToeGame from a table that is solved at compile time
+// and kept in PROGMEM (9842 bytes: the best cell of every position). It is
+// used like MinimaxAI, but each move is a table lookup instead of a search.
+class TicTacToeSolver {
+public:
+    TicTacToeSolver(TicTacToeGame &gameRef);
+
+    // The best move for the side to move: the fastest win, else a draw,
+    // else the slowest loss. Returns {0, 0} if the game is over.
+    Move findBestMove();
+
+    // Every move that keeps the value of the position, as a mask of cells.
+    uint16_t optimalMoves();
+
+    // The value of the position with perfect play: SCORE_WIN if the AI
+    // wins, -SCORE_WIN if the Human wins, 0 for a draw.
+    Score getScore();
+
+private:
+    TicTacToeGame *game;
+};
+
+#endif // TIC_TAC_TOE_SOLVER_H
@@ -3,14 +3,25 @@
 #include "MinimaxAI.h"
 
 TicTacToeGame game;
+
+// The engine reserves a search frame of MAX_MOVES moves (32 by default, for
+// checkers) for each of MINIMAX_MAX_PLY plies (10 by default): about 790
+// bytes on AVR. Tic-Tac-Toe never has more than 9 moves or 9 plies, so
+// build with -DMAX_MOVES=9 -DMINIMAX_MAX_PLY=9 to bring that down to about
+// 300 bytes, for example with arduino-cli:
+//   arduino-cli compile --build-property "compiler.cpp.extra_flags=-DMAX_MOVES=9 -DMINIMAX_MAX_PLY=9"
+// The flags must reach the library as well as the sketch, so do not #define
+// them here.
 MinimaxAI ai(game, 9);  // Use full-depth search for Tic-Tac-Toe
+static_assert(MAX_MOVES >= 9, "MAX_MOVES is below the 9 moves of Tic-Tac-Toe");
+static_assert(MINIMAX_MAX_PLY >= 9, "MINIMAX_MAX_PLY is below the sketch's full-depth search");
 
 // Helper function to print the board state to Serial.
 void printBoard() {
   const char symbols[3] = { ' ', 'X', 'O' };
   Serial.println(F("Board:"));
   for (int i = 0; i < 9; i++) {
-    Serial.print(symbols[ game.board[i] ]);
+    Serial.print(symbols[ game.cell(i) ]);
     if ((i % 3) == 2)
       Serial.println();
     else
@@ -24,6 +35,9 @@ void setup() {
   while (!Serial);       // Wait for Serial Monitor to open (if needed)
   
   Serial.println(F("Tic-Tac-Toe AI: Human vs Engine"));
+  Serial.print(F("Engine search stack: "));
+  Serial.print(MinimaxAI::SEARCH_STACK_BYTES);
+  Serial.println(F(" bytes"));
   game.reset_game();
   printBoard();
   
@@ -50,7 +64,7 @@ void loop() {
       char c = Serial.read();
       if (c >= '1' && c <= '9') {
         uint8_t pos = c - '1';  // Convert char '1'-'9' to board index 0-8.
-        if (game.board[pos] == 0) {
+        if (game.cell(pos) == 0) {
           Move m = { pos, pos };
           game.applyMove(m);
           printBoard();
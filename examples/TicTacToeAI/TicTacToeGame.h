@@ -6,15 +6,22 @@
 // Simple enumeration for the two players.
 enum Player { HUMAN = 0, AI = 1 };
 
+// The whole game state. The board is held as two 9-bit masks (bit i set =
+// cell i taken by that side) so win tests and line scoring are a handful of
+// AND/compare instructions, and the engine can copy it for copy-make search.
+struct TicTacToeState {
+    uint16_t aiMask;     // Cells marked by the AI (mark 1 = X)
+    uint16_t humanMask;  // Cells marked by the Human (mark 2 = O)
+    Player current;      // Indicates whose turn it is
+};
+
 // TicTacToeGame implements GameInterface for a standard 3x3 Tic-Tac-Toe game.
-class TicTacToeGame : public GameInterface {
+class TicTacToeGame : public GameInterface, public TicTacToeState {
 public:
-    uint8_t board[9];  // 3x3 board stored in a 1D array (0 = empty, 1 = X, 2 = O)
-    Player current;    // Indicates whose turn it is
 
     TicTacToeGame();
 
-    // Evaluate board: +10 if AI wins, -10 if Human wins,
+    // Evaluate board: +SCORE_WIN if AI wins, -SCORE_WIN if Human wins,
     // or a heuristic score based on potential wins/losses.
     int evaluateBoard() override;
 
@@ -33,9 +40,25 @@ public:
     // Return +1 if it's AI's turn (maximizing), -1 if Human's turn.
     int currentPlayer() override;
 
+    // Copy-make support: the TicTacToeState part of the game is the whole state.
+    uint8_t stateSize() override;
+    void *stateData() override;
+
+    // The two masks and the side to move form an exact position key.
+    bool positionKey(uint32_t &key) override;
+
+    // The board has 8 symmetries (4 rotations, 4 reflections). The canonical
+    // key is the smallest positionKey() over all of them.
+    bool canonicalKey(uint32_t &key, uint8_t &transform) override;
+    Move transformMove(const Move &m, uint8_t transform, bool inverse) override;
+    bool isSymmetric() override;
+
     // Reset the game board and state for a new game.
     void reset_game();
 
+    // Return the mark in cell i (0-8): 0 = empty, 1 = X, 2 = O.
+    uint8_t cell(uint8_t i) const;
+
     // Expose isWinner publicly so that it can be checked externally.
     bool isWinner(uint8_t mark);
 
@@ -50,4 +73,3 @@ private:
 };
 
 #endif // TIC_TAC_TOE_GAME_H
-
@@ -0,0 +1,297 @@
+// Streaming analysis server: keeps one MinimaxAI and its transposition table
+// warm and answers a stream of checkers positions read from stdin or from a
+// Unix socket. Clients may send many requests without waiting; the answers
+// come back in request order, written out in batches.
+//
+// Build from the library root:
+//   g++ -O2 -std=c++11 -pthread -Iextras/host -Isrc -Iexamples/CheckersAI
+//       extras/host/AnalysisServer.cpp src/*.cpp examples/CheckersAI/CheckersGame.cpp -o analysisd
+// Run:
+//   ./analysisd [depth] [nodeBudget] [binary|text] [socketPath]
+// Without a socketPath it serves stdin/stdout. With one it listens there and
+// serves one connection at a time; the engine stays warm between them.
+//
+// Binary requests are 16 bytes, little endian:
+//    0  uint32 ai     AI pieces, bit i = playable square i (as in CheckersBoard)
+//    4  uint32 human  Human pieces
+//    8  uint32 kings  Kings of either side
+//   12  uint8  side   Side to move (SIDE_AI = 1, SIDE_HUMAN = 0)
+//   13  uint8  depth  Maximum depth (0 = the server's)
+//   14  uint16 id     Echoed in the answer
+// Binary answers are 12 bytes:
+//    0  uint16 id
+//    2  uint8  from   Best move (squares 0-31)
+//    3  uint8  to
+//    4  int16  score  Score of the move; positive favours the AI side
+//    6  uint8  depth  Depth completed
+//    7  uint8  status ANSWER_OK, ANSWER_GAME_OVER, ANSWER_BAD_REQUEST or
+//                     ANSWER_NO_RESULT (the node budget ran out before depth
+//                     1 completed; from, to and score are 0)
+//    8  uint32 nodes  Nodes searched
+//
+// Text requests are lines of 32 characters for squares 1-32 ('.' empty,
+// 'a'/'A' AI man/king, 'h'/'H' Human man/king), the side to move ('a' or
+// 'h') and optionally a depth:
+//   aaaaaaaaaaaa........hhhhhhhhhhhh a 6
+// Text answers are "ok <from> <to> <score> <depth> <nodes>" with squares
+// 1-32 as printed by CheckersAI, "over", "error" or "none <nodes>" when no
+// depth completed within the node budget.
+//
+// A position is only its board and side to move: the history used for
+// repetition penalties and for reversal filtering starts empty.
+
+#include "MinimaxBatch.h"
+#include "CheckersGame.h"
+
+#include <signal.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+#define REQUEST_BYTES 16
+
+#define ANSWER_OK 0
+#define ANSWER_GAME_OVER 1
+#define ANSWER_BAD_REQUEST 2
+#define ANSWER_NO_RESULT 3
+
+// Longest text request line accepted.
+#define TEXT_LINE_MAX 64
+
+// A decoded request.
+struct Request {
+    CheckersBoard board;
+    uint8_t side;
+    uint8_t depth;
+    uint16_t id;
+    bool valid;  // The request could be decoded
+};
+
+// The engine and its caches, kept for the life of the server.
+struct Analyzer {
+    CheckersGame game;
+    std::vector<CheckersState> plyStates;
+    std::vector<TTEntry> entries;
+    TranspositionTable table;
+    MinimaxAI ai;
+    uint8_t maxDepth;
+    uint32_t nodeBudget;
+
+    Analyzer(uint8_t depth, uint32_t budget)
+        : plyStates(MINIMAX_MAX_PLY), entries(1 << 20), table(entries.data(), entries.size()),
+          ai(game, depth), maxDepth(depth), nodeBudget(budget) {
+        ai.setStateBuffer(plyStates.data(), plyStates.size() * sizeof(CheckersState));
+        ai.setTranspositionTable(&table);
+    }
+};
+
+static uint32_t readLittle32(const uint8_t *p) {
+    return p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void writeLittle16(std::string &out, uint16_t v) {
+    out.push_back((char)(v & 0xFF));
+    out.push_back((char)(v >> 8));
+}
+
+static void writeLittle32(std::string &out, uint32_t v) {
+    writeLittle16(out, (uint16_t)v);
+    writeLittle16(out, (uint16_t)(v >> 16));
+}
+
+// Decode one binary request from the front of data. Returns the bytes it
+// took, or 0 if the request is not complete yet.
+static size_t parseBinary(const uint8_t *data, size_t length, Request &request) {
+    if (length < REQUEST_BYTES) {
+        return 0;
+    }
+    request.board.ai = readLittle32(data);
+    request.board.human = readLittle32(data + 4);
+    request.board.kings = readLittle32(data + 8);
+    request.side = data[12];
+    request.depth = data[13];
+    request.id = data[14] | (data[15] << 8);
+    request.valid = true;
+    return REQUEST_BYTES;
+}
+
+// Decode one text request line from the front of data, the same way.
+static size_t parseText(const uint8_t *data, size_t length, Request &request) {
+    request.board.ai = request.board.human = request.board.kings = 0;
+    request.side = SIDE_AI;
+    request.depth = 0;
+    request.id = 0;
+    request.valid = false;
+
+    const uint8_t *end = (const uint8_t *)memchr(data, '\n', length);
+    if (end == nullptr) {
+        // An overlong line without a newline can never be complete: drop it.
+        return (length > TEXT_LINE_MAX) ? length : 0;
+    }
+    std::string line((const char *)data, end - data);
+
+    // Read one character more than a board so that a longer token is
+    // seen and rejected instead of being split into board and side.
+    char squares[NUM_SQUARES + 2];
+    char side;
+    int depth = 0;
+    if (sscanf(line.c_str(), "%33s %c %d", squares, &side, &depth) >= 2 && strlen(squares) == NUM_SQUARES &&
+        (side == 'a' || side == 'h') && depth >= 0 && depth <= 255) {
+        request.valid = true;
+        for (uint8_t i = 0; i < NUM_SQUARES; i++) {
+            uint32_t bit = 1UL << i;
+            switch (squares[i]) {
+            case '.': break;
+            case 'a': request.board.ai |= bit; break;
+            case 'A': request.board.ai |= bit; request.board.kings |= bit; break;
+            case 'h': request.board.human |= bit; break;
+            case 'H': request.board.human |= bit; request.board.kings |= bit; break;
+            default: request.valid = false; break;
+            }
+        }
+        request.side = (side == 'a') ? SIDE_AI : SIDE_HUMAN;
+        request.depth = (uint8_t)depth;
+    }
+    return end - data + 1;
+}
+
+// Search a request's position and encode the answer onto out.
+static void answer(Analyzer &analyzer, const Request &request, bool text, std::string &out) {
+    const CheckersBoard &board = request.board;
+    BatchResult result = {{0, 0}, 0, 0, 0};
+    uint8_t status = ANSWER_OK;
+    if (!request.valid || request.side > SIDE_AI || (board.ai & board.human) != 0 ||
+        (board.kings & ~(board.ai | board.human)) != 0) {
+        status = ANSWER_BAD_REQUEST;
+    } else {
+        CheckersGame &game = analyzer.game;
+        game.board = board;
+        game.currentSide = request.side;
+        game.lastMoveValid = false;
+        game.historySize = 0;
+        if (game.isGameOver()) {
+            status = ANSWER_GAME_OVER;
+        } else {
+            uint8_t depth = (request.depth != 0) ? request.depth : analyzer.maxDepth;
+            analyzePosition(analyzer.ai, depth, analyzer.nodeBudget, result);
+            if (result.depth == 0) {
+                status = ANSWER_NO_RESULT;
+            }
+        }
+    }
+
+    if (!text) {
+        writeLittle16(out, request.id);
+        out.push_back((char)result.bestMove.from);
+        out.push_back((char)result.bestMove.to);
+        writeLittle16(out, (uint16_t)result.score);
+        out.push_back((char)result.depth);
+        out.push_back((char)status);
+        writeLittle32(out, result.nodes);
+        return;
+    }
+    char line[64];
+    if (status == ANSWER_OK) {
+        snprintf(line, sizeof(line), "ok %u %u %d %u %u\n", result.bestMove.from + 1, result.bestMove.to + 1,
+                 (int)result.score, result.depth, result.nodes);
+    } else if (status == ANSWER_NO_RESULT) {
+        snprintf(line, sizeof(line), "none %u\n", result.nodes);
+    } else {
+        snprintf(line, sizeof(line), "%s\n", (status == ANSWER_GAME_OVER) ? "over" : "error");
+    }
+    out += line;
+}
+
+static bool writeAll(int fd, const std::string &data) {
+    size_t done = 0;
+    while (done < data.size()) {
+        ssize_t n = write(fd, data.data() + done, data.size() - done);
+        if (n <= 0) {
+            return false;
+        }
+        done += n;
+    }
+    return true;
+}
+
+// Answer requests from in on out until in is closed. Every request already
+// received is answered before the answers are written, so a pipelining
+// client gets them in one write instead of one per request.
+static void serve(Analyzer &analyzer, int in, int out, bool text) {
+    std::vector<uint8_t> buffer(1 << 16);
+    size_t length = 0;
+    std::string answers;
+    for (;;) {
+        ssize_t n = read(in, buffer.data() + length, buffer.size() - length);
+        if (n <= 0) {
+            return;
+        }
+        length += n;
+
+        size_t used = 0;
+        for (;;) {
+            Request request;
+            size_t taken = text ? parseText(buffer.data() + used, length - used, request)
+                                : parseBinary(buffer.data() + used, length - used, request);
+            if (taken == 0) {
+                break;
+            }
+            used += taken;
+            answer(analyzer, request, text, answers);
+        }
+        memmove(buffer.data(), buffer.data() + used, length - used);
+        length -= used;
+
+        if (!writeAll(out, answers)) {
+            return;
+        }
+        answers.clear();
+    }
+}
+
+// Listen on a Unix socket and serve its connections one after another.
+static int serveSocket(Analyzer &analyzer, const char *path, bool text) {
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "socket path too long: %s\n", path);
+        return 1;
+    }
+    strcpy(address.sun_path, path);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(path);
+    if (listener < 0 || bind(listener, (sockaddr *)&address, sizeof(address)) != 0 || listen(listener, 8) != 0) {
+        perror("cannot listen");
+        return 1;
+    }
+    fprintf(stderr, "listening on %s\n", path);
+    for (;;) {
+        int connection = accept(listener, nullptr, nullptr);
+        if (connection < 0) {
+            continue;
+        }
+        serve(analyzer, connection, connection, text);
+        close(connection);
+    }
+}
+
+int main(int argc, char **argv) {
+    uint8_t depth = (argc > 1) ? atoi(argv[1]) : 8;
+    uint32_t budget = (argc > 2) ? atoi(argv[2]) : 0;
+    bool text = (argc > 3) && strcmp(argv[3], "text") == 0;
+    const char *socketPath = (argc > 4) ? argv[4] : nullptr;
+
+    // A client that goes away should end its connection, not the server.
+    signal(SIGPIPE, SIG_IGN);
+
+    Analyzer analyzer(depth, budget);
+    if (socketPath != nullptr) {
+        return serveSocket(analyzer, socketPath, text);
+    }
+    serve(analyzer, STDIN_FILENO, STDOUT_FILENO, text);
+    return 0;
+}
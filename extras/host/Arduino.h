@@ -0,0 +1,63 @@
+#ifndef MINIMAX_HOST_ARDUINO_H
+#define MINIMAX_HOST_ARDUINO_H
+
+// Minimal stand-in for the Arduino core so the library and the example games
+// can be compiled into host programs (see the tools in this directory).
+// Only what the library and examples use is provided; Serial writes to stdout.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#define PROGMEM
+#define F(str) (str)
+
+inline uint8_t pgm_read_byte(const void *addr) { return *(const uint8_t *)addr; }
+inline uint16_t pgm_read_word(const void *addr) { return *(const uint16_t *)addr; }
+
+inline unsigned long micros() {
+    using namespace std::chrono;
+    return (unsigned long)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+inline unsigned long millis() { return micros() / 1000; }
+inline void delay(unsigned long) {}
+
+// Analog inputs read as 0 (sketches use them to seed random numbers).
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+inline int analogRead(uint8_t) { return 0; }
+
+inline long random(long howBig) { return howBig > 0 ? rand() % howBig : 0; }
+inline long random(long howSmall, long howBig) { return howSmall + random(howBig - howSmall); }
+inline void randomSeed(unsigned long seed) { srand((unsigned)seed); }
+
+// Printing to stdout with the Arduino Print API.
+class HostSerial {
+public:
+    void begin(unsigned long) {}
+    int available() { return 0; }
+    int read() { return -1; }
+    explicit operator bool() const { return true; }
+
+    void print(const char *s) { fputs(s, stdout); }
+    void print(char c) { fputc(c, stdout); }
+    void print(int v) { printf("%d", v); }
+    void print(unsigned int v) { printf("%u", v); }
+    void print(long v) { printf("%ld", v); }
+    void print(unsigned long v) { printf("%lu", v); }
+    void print(double v, int digits = 2) { printf("%.*f", digits, v); }
+
+    template <typename T>
+    void println(T v) { print(v); fputc('\n', stdout); }
+    void println(double v, int digits) { print(v, digits); fputc('\n', stdout); }
+    void println() { fputc('\n', stdout); }
+};
+
+static HostSerial Serial __attribute__((unused));
+
+#endif // MINIMAX_HOST_ARDUINO_H
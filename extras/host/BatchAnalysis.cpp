@@ -0,0 +1,85 @@
+// Batch analysis benchmark: searches a set of checkers positions on a thread
+// pool with a shared transposition table and reports positions per second.
+//
+// Build from the library root:
+//   g++ -O2 -std=c++11 -pthread -Iextras/host -Isrc -Iexamples/CheckersAI
+//       extras/host/BatchAnalysis.cpp src/*.cpp examples/CheckersAI/CheckersGame.cpp -o batch
+// Run:
+//   ./batch [positions] [threads] [depth] [nodeBudget] [cacheFile]
+// With a cacheFile the table is kept in that file (see PersistentTable), so a
+// second run starts with the results of the first.
+
+#include "MinimaxBatch.h"
+#include "PersistentTable.h"
+#include "CheckersGame.h"
+
+#include <vector>
+
+// Build positions by playing random legal moves from the opening.
+static void makePositions(std::vector<CheckersState> &positions, uint32_t count) {
+    CheckersGame game;
+    srand(1);
+    for (uint32_t i = 0; i < count; i++) {
+        game.reset_game();
+        uint8_t plies = 4 + rand() % 30;
+        for (uint8_t p = 0; p < plies && !game.isGameOver(); p++) {
+            Move moves[MAX_MOVES];
+            uint8_t n = game.generateMoves(moves);
+            game.applyMove(moves[rand() % n]);
+        }
+        if (game.isGameOver()) {
+            i--;
+            continue;
+        }
+        game.historySize = 0;  // Positions are analyzed without their history.
+        positions.push_back(game);
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t count = (argc > 1) ? atoi(argv[1]) : 2000;
+    uint8_t threads = (argc > 2) ? atoi(argv[2]) : 4;
+    uint8_t depth = (argc > 3) ? atoi(argv[3]) : 6;
+    uint32_t budget = (argc > 4) ? atoi(argv[4]) : 0;
+    const char *cacheFile = (argc > 5) ? argv[5] : nullptr;
+
+    std::vector<CheckersState> positions;
+    makePositions(positions, count);
+
+    std::vector<CheckersGame> games(threads);
+    std::vector<GameInterface *> gamePtrs;
+    for (CheckersGame &game : games) {
+        gamePtrs.push_back(&game);
+    }
+
+    std::vector<TTEntry> entries(cacheFile != nullptr ? 1 : 1 << 20);
+    TranspositionTable memoryTable(entries.data(), entries.size());
+    TranspositionTable *table = &memoryTable;
+    PersistentTable cache;
+    if (cacheFile != nullptr) {
+        // The game id ties the file to the checkers positionKey() scheme.
+        if (!cache.open(cacheFile, 1 << 20, 0x434B5231)) {
+            fprintf(stderr, "cannot open cache file %s\n", cacheFile);
+            return 1;
+        }
+        printf("cache:            %s\n", cache.isWarm() ? "warm" : "cold");
+        table = &cache;
+    }
+    std::vector<BatchResult> results(count);
+
+    BatchStats stats = analyzeBatch(gamePtrs.data(), threads, positions.data(), count,
+                                    depth, budget, table, results.data());
+
+    uint32_t reached = 0;
+    for (const BatchResult &result : results) {
+        reached += result.depth;
+    }
+    printf("positions:        %u\n", stats.positions);
+    printf("threads:          %u\n", threads);
+    printf("average depth:    %.2f\n", (double)reached / count);
+    printf("nodes:            %llu\n", (unsigned long long)stats.nodes);
+    printf("seconds:          %.3f\n", stats.seconds);
+    printf("positions/second: %.1f\n", stats.positionsPerSecond);
+    printf("nodes/second:     %.0f\n", stats.nodesPerSecond);
+    return 0;
+}
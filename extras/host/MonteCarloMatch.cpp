@@ -0,0 +1,108 @@
+// MCTS against alpha-beta: measures MonteCarloAI's playout rate with 1 to N
+// threads, then plays checkers games between MonteCarloAI and MinimaxAI.
+//
+// Build from the library root:
+//   g++ -O2 -std=c++11 -pthread -Iextras/host -Isrc -Iexamples/CheckersAI
+//       extras/host/MonteCarloMatch.cpp src/*.cpp examples/CheckersAI/CheckersGame.cpp -o mcts
+// Run:
+//   ./mcts [games] [iterations] [depth] [threads]
+
+#include "MonteCarloAI.h"
+#include "MinimaxAI.h"
+#include "CheckersGame.h"
+
+#include <chrono>
+#include <vector>
+
+// Games longer than this are scored as draws.
+#define MATCH_MAX_PLIES 200
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Playouts per second from the opening for 1 to maxThreads threads.
+static void throughput(std::vector<MctsNode> &pool, uint32_t iterations, uint8_t maxThreads) {
+    std::vector<CheckersGame> games(maxThreads);
+    std::vector<GameInterface *> gamePointers;
+    for (CheckersGame &game : games) {
+        gamePointers.push_back(&game);
+    }
+
+    printf("threads  playouts/s  nodes  move\n");
+    for (uint8_t threads = 1; threads <= maxThreads; threads *= 2) {
+        MonteCarloAI mcts(games[0], pool.data(), (uint16_t)pool.size());
+        mcts.setIterationLimit(iterations);
+        auto start = std::chrono::steady_clock::now();
+        Move move = mcts.findBestMoveParallel(gamePointers.data(), threads);
+        double seconds = secondsSince(start);
+        printf("%7u %11.0f %6u  %u-%u\n", threads, mcts.getIterationCount() / seconds,
+               mcts.getNodesUsed(), move.from, move.to);
+    }
+}
+
+// Play one game; MonteCarloAI plays the AI side if mctsIsAi.
+// Returns +1 if MonteCarloAI won, -1 if it lost, 0 for a draw.
+static int playGame(std::vector<MctsNode> &pool, uint32_t iterations, uint8_t depth, uint8_t threads,
+                    bool mctsIsAi, uint32_t seed, double &mctsSeconds, double &minimaxSeconds) {
+    std::vector<CheckersGame> games(threads);
+    std::vector<GameInterface *> gamePointers;
+    for (CheckersGame &game : games) {
+        gamePointers.push_back(&game);
+    }
+    CheckersGame &game = games[0];
+
+    MonteCarloAI mcts(game, pool.data(), (uint16_t)pool.size());
+    mcts.setIterationLimit(iterations);
+    mcts.setSeed(seed);
+    MinimaxAI minimax(game, depth);
+    CheckersState plyStates[MINIMAX_MAX_PLY];
+    minimax.setStateBuffer(plyStates, sizeof(plyStates));
+
+    for (uint16_t plies = 0; plies < MATCH_MAX_PLIES; plies++) {
+        if (game.isGameOver()) {
+            // The side to move has no moves or no pieces left.
+            bool aiLost = (game.currentSide == SIDE_AI);
+            return (aiLost == mctsIsAi) ? -1 : 1;
+        }
+        bool mctsToMove = ((game.currentSide == SIDE_AI) == mctsIsAi);
+        auto start = std::chrono::steady_clock::now();
+        Move move;
+        if (mctsToMove) {
+            // The helper games follow the real one.
+            for (uint8_t t = 1; t < threads; t++) {
+                static_cast<CheckersState &>(games[t]) = game;
+            }
+            move = mcts.findBestMoveParallel(gamePointers.data(), threads);
+            mctsSeconds += secondsSince(start);
+        } else {
+            move = minimax.findBestMove();
+            minimaxSeconds += secondsSince(start);
+        }
+        game.applyMove(move);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    uint32_t gameCount = (argc > 1) ? atoi(argv[1]) : 10;
+    uint32_t iterations = (argc > 2) ? atoi(argv[2]) : 5000;
+    uint8_t depth = (argc > 3) ? atoi(argv[3]) : 4;
+    uint8_t threads = (argc > 4) ? atoi(argv[4]) : 4;
+
+    std::vector<MctsNode> pool(60000);
+    throughput(pool, iterations * 4, threads);
+
+    uint32_t wins = 0, draws = 0, losses = 0;
+    double mctsSeconds = 0, minimaxSeconds = 0;
+    for (uint32_t i = 0; i < gameCount; i++) {
+        int result = playGame(pool, iterations, depth, threads, (i & 1) == 0, i + 1, mctsSeconds, minimaxSeconds);
+        wins += (result > 0);
+        draws += (result == 0);
+        losses += (result < 0);
+    }
+    printf("\nMonteCarloAI (%u playouts, %u threads) vs MinimaxAI (depth %u): "
+           "%u wins, %u draws, %u losses\n", iterations, threads, depth, wins, draws, losses);
+    printf("thinking time: MonteCarloAI %.2f s, MinimaxAI %.2f s\n", mctsSeconds, minimaxSeconds);
+    return 0;
+}
@@ -0,0 +1,141 @@
+// Search trace tool: records the search trees of checkers positions to a
+// file and reports where the nodes went.
+//
+// Build from the library root (the trace hook needs MINIMAX_TRACE):
+//   g++ -O2 -std=c++11 -DMINIMAX_TRACE -Iextras/host -Isrc -Iexamples/CheckersAI
+//       extras/host/SearchTrace.cpp src/*.cpp examples/CheckersAI/CheckersGame.cpp -o trace
+// Run:
+//   ./trace record <file> [positions] [depth] [multiPV]
+//   ./trace analyze <file>
+//
+// With multiPV > 0 the positions are searched with findBestMoves() for that
+// many moves. The file is a stream of TraceRecord structs in host byte order.
+
+#include "MinimaxAI.h"
+#include "CheckersGame.h"
+
+#include <vector>
+
+static void writeRecord(const TraceRecord &record, void *context) {
+    fwrite(&record, sizeof(record), 1, (FILE *)context);
+}
+
+static int record(const char *path, uint32_t count, uint8_t depth, uint8_t multiPV) {
+    FILE *file = fopen(path, "wb");
+    if (file == nullptr) {
+        fprintf(stderr, "cannot write %s\n", path);
+        return 1;
+    }
+
+    CheckersGame game;
+    MinimaxAI ai(game, depth);
+    ai.setTraceSink(writeRecord, file);
+
+    // Search positions reached by random legal moves from the opening.
+    srand(1);
+    uint64_t nodes = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        game.reset_game();
+        uint8_t plies = 4 + rand() % 30;
+        for (uint8_t p = 0; p < plies && !game.isGameOver(); p++) {
+            Move moves[MAX_MOVES];
+            uint8_t n = game.generateMoves(moves);
+            game.applyMove(moves[rand() % n]);
+        }
+        if (game.isGameOver()) {
+            i--;
+            continue;
+        }
+        if (multiPV > 0) {
+            ScoredMove best[MAX_MOVES];
+            ai.findBestMoves(best, multiPV > MAX_MOVES ? MAX_MOVES : multiPV);
+        } else {
+            ai.findBestMove();
+        }
+        nodes += ai.getNodeCount();
+    }
+
+    fclose(file);
+    printf("%u searches at depth %u, %llu nodes\n", count, ai.getDepth(), (unsigned long long)nodes);
+    return 0;
+}
+
+// Per-ply totals over all searches.
+struct PlyStats {
+    uint64_t nodes;      // Interior nodes at this ply
+    uint64_t children;   // Children searched below them
+    uint64_t cutoffs;    // Nodes that failed high
+    uint64_t firstMove;  // Of those, nodes that failed high on the first move
+};
+
+static int analyze(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (file == nullptr) {
+        fprintf(stderr, "cannot read %s\n", path);
+        return 1;
+    }
+
+    PlyStats plies[MINIMAX_MAX_PLY + 1];
+    memset(plies, 0, sizeof(plies));
+    std::vector<TraceRecord> rootMoves;
+    uint32_t searches = 0;
+    TraceRecord rec;
+
+    while (fread(&rec, sizeof(rec), 1, file) == 1) {
+        if (rec.ply <= MINIMAX_MAX_PLY) {
+            PlyStats &stats = plies[rec.ply];
+            stats.nodes++;
+            if (rec.cutoff != 0xFF) {
+                stats.children += rec.cutoff + 1;
+                stats.cutoffs++;
+                stats.firstMove += (rec.cutoff == 0);
+            } else {
+                stats.children += rec.count;
+            }
+        }
+        if (rec.ply == 1) {
+            rootMoves.push_back(rec);
+        } else if (rec.ply == 0) {
+            // The root closes a search: show how its nodes split by root move.
+            printf("search %u: %u nodes, score %d\n", ++searches, rec.nodes, rec.score);
+            for (const TraceRecord &child : rootMoves) {
+                printf("  %2u-%-2u %9u nodes %5.1f%%  window [%d, %d] -> [%d, %d], score %d\n",
+                       child.move.from, child.move.to, child.nodes, 100.0 * child.nodes / rec.nodes,
+                       child.alphaIn, child.betaIn, child.alphaOut, child.betaOut, child.score);
+            }
+            rootMoves.clear();
+        }
+    }
+    fclose(file);
+
+    // The effective branching factor of a ply is the number of nodes searched
+    // at the next ply per node at this one. Leaves are not recorded, so the
+    // last ply's children count the leaves.
+    printf("\nply  interior nodes   children    EBF  cutoffs  first-move cutoffs\n");
+    for (uint8_t p = 0; p <= MINIMAX_MAX_PLY; p++) {
+        const PlyStats &stats = plies[p];
+        if (stats.nodes == 0) {
+            continue;
+        }
+        printf("%3u %15llu %10llu %6.2f %8llu  %6.1f%%\n", p,
+               (unsigned long long)stats.nodes, (unsigned long long)stats.children,
+               (double)stats.children / stats.nodes, (unsigned long long)stats.cutoffs,
+               stats.cutoffs ? 100.0 * stats.firstMove / stats.cutoffs : 0.0);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 3 && strcmp(argv[1], "record") == 0) {
+        uint32_t count = (argc > 3) ? atoi(argv[3]) : 20;
+        uint8_t depth = (argc > 4) ? atoi(argv[4]) : 6;
+        uint8_t multiPV = (argc > 5) ? atoi(argv[5]) : 0;
+        return record(argv[2], count, depth, multiPV);
+    }
+    if (argc >= 3 && strcmp(argv[1], "analyze") == 0) {
+        return analyze(argv[2]);
+    }
+    fprintf(stderr, "usage: %s record <file> [positions] [depth] [multiPV]\n"
+                    "       %s analyze <file>\n", argv[0], argv[0]);
+    return 1;
+}
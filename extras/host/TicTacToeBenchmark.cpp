@@ -0,0 +1,117 @@
+// Compares the compile-time TicTacToe table (TicTacToeSolver) with a full
+// depth MinimaxAI search on every position reachable in a game: checks that
+// both agree on the value and that each picks an optimal move, and times them.
+// Also checks that multi-PV analysis (findBestMoves) leaves the game's state
+// byte for byte as it found it.
+//
+// Build from the library root:
+//   g++ -O2 -std=c++11 -Iextras/host -Isrc -Iexamples/EngineVsEngine
+//       extras/host/TicTacToeBenchmark.cpp src/*.cpp examples/EngineVsEngine/TicTacToe*.cpp -o tttbench
+// Run:
+//   ./tttbench
+
+#include "MinimaxAI.h"
+#include "TicTacToeGame.h"
+#include "TicTacToeSolver.h"
+
+#include <chrono>
+#include <vector>
+
+// Collect every position with moves left, reached from the empty board
+// with the AI moving first, excluding the empty board (which the game
+// answers from its opening book).
+static void collect(TicTacToeGame &game, std::vector<TicTacToeState> &positions, std::vector<bool> &seen) {
+    uint32_t key;
+    game.positionKey(key);
+    if (seen[key]) {
+        return;
+    }
+    seen[key] = true;
+    if (game.isGameOver()) {
+        return;
+    }
+    if (!game.isBoardEmpty()) {
+        positions.push_back(game);
+    }
+    Move moves[MAX_MOVES];
+    uint8_t count = game.generateMoves(moves);
+    for (uint8_t i = 0; i < count; i++) {
+        game.applyMove(moves[i]);
+        collect(game, positions, seen);
+        game.undoMove(moves[i]);
+    }
+}
+
+static int sign(int v) {
+    return (v > 0) - (v < 0);
+}
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    TicTacToeGame game;
+    std::vector<TicTacToeState> positions;
+    std::vector<bool> seen(1 << 19);
+    collect(game, positions, seen);
+
+    TicTacToeSolver solver(game);
+    MinimaxAI ai(game, 9);
+    TicTacToeState searchStates[9];
+    ai.setStateBuffer(searchStates, sizeof(searchStates));
+
+    // Agreement: same value, and each engine's move is among the optimal ones.
+    uint32_t valueMismatches = 0, solverNotOptimal = 0, searchNotOptimal = 0;
+    uint32_t multiNotOptimal = 0, stateChanged = 0;
+    for (const TicTacToeState &position : positions) {
+        static_cast<TicTacToeState &>(game) = position;
+        uint16_t optimal = solver.optimalMoves();
+        Move tableMove = solver.findBestMove();
+        Move searchMove = ai.findBestMove();
+        valueMismatches += sign(solver.getScore()) != sign(ai.getScore());
+        solverNotOptimal += ((optimal >> tableMove.to) & 1) == 0;
+        searchNotOptimal += ((optimal >> searchMove.to) & 1) == 0;
+
+        uint8_t before[sizeof(TicTacToeState)];
+        memcpy(before, game.stateData(), game.stateSize());
+        ScoredMove best[1];
+        if (ai.findBestMoves(best, 1) > 0) {
+            multiNotOptimal += ((optimal >> best[0].move.to) & 1) == 0;
+        }
+        stateChanged += memcmp(before, game.stateData(), game.stateSize()) != 0;
+    }
+
+    // Timing: one move decision per position.
+    const int rounds = 1000;
+    auto start = std::chrono::steady_clock::now();
+    uint32_t checksum = 0;
+    for (int r = 0; r < rounds; r++) {
+        for (const TicTacToeState &position : positions) {
+            static_cast<TicTacToeState &>(game) = position;
+            checksum += solver.findBestMove().to;
+        }
+    }
+    double tableTime = seconds(start) / rounds;
+
+    start = std::chrono::steady_clock::now();
+    uint64_t nodes = 0;
+    for (const TicTacToeState &position : positions) {
+        static_cast<TicTacToeState &>(game) = position;
+        checksum += ai.findBestMove().to;
+        nodes += ai.getNodeCount();
+    }
+    double searchTime = seconds(start);
+
+    printf("positions:             %u\n", (unsigned)positions.size());
+    printf("value mismatches:      %u\n", valueMismatches);
+    printf("non-optimal (table):   %u\n", solverNotOptimal);
+    printf("non-optimal (search):  %u\n", searchNotOptimal);
+    printf("non-optimal (multi):   %u\n", multiNotOptimal);
+    printf("state changed (multi): %u\n", stateChanged);
+    printf("table:  %9.3f us per move\n", tableTime * 1e6 / positions.size());
+    printf("search: %9.3f us per move, %.0f nodes per move\n",
+           searchTime * 1e6 / positions.size(), (double)nodes / positions.size());
+    printf("speedup: %.0fx  (checksum %u)\n", searchTime / tableTime, checksum);
+    return 0;
+}
@@ -0,0 +1,7 @@
+#ifndef MINIMAX_HOST_AVR_PGMSPACE_H
+#define MINIMAX_HOST_AVR_PGMSPACE_H
+
+// PROGMEM and pgm_read_*() come from the host Arduino.h.
+#include <Arduino.h>
+
+#endif // MINIMAX_HOST_AVR_PGMSPACE_H
@@ -2,11 +2,36 @@
 #define GAME_INTERFACE_H
 
 #include <Arduino.h>
+#include <limits.h>
 #include <stdint.h>
 #include <string.h>
 
-// Adjust MAX_MOVES as needed.
-#define MAX_MOVES 9
+// Adjust MAX_MOVES as needed. It must cover the largest move list any game
+// can generate: the engine keeps one list of this size per search ply.
+// Override it with a compiler flag so the library and the sketch agree.
+#ifndef MAX_MOVES
+#define MAX_MOVES 32
+#endif
+
+// The score type used by the search. int16_t keeps search frames and cache
+// entries small; override it with a compiler flag (for example
+// -DMINIMAX_SCORE_TYPE=int32_t) if a game needs more range. The bounds
+// below follow the type, but a TranspositionTable only keeps results whose
+// score fits in 16 bits.
+#ifndef MINIMAX_SCORE_TYPE
+#define MINIMAX_SCORE_TYPE int16_t
+#endif
+typedef MINIMAX_SCORE_TYPE Score;
+
+// Score bounds. evaluateBoard() should return SCORE_WIN when the maximizing
+// player has won and -SCORE_WIN when it has lost. The engine turns these into
+// scores that prefer faster wins and slower losses, and clamps heuristic
+// scores so they never look like a win.
+// SCORE_INFINITY is the largest Score that is also an int, as evaluateBoard()
+// returns an int (32767 with the default type); SCORE_WIN leaves room below
+// it for the win distances (32000 with the default type).
+#define SCORE_INFINITY ((Score)(sizeof(Score) < sizeof(int) ? (1L << (8 * sizeof(Score) - 1)) - 1 : INT_MAX))
+#define SCORE_WIN      ((Score)(SCORE_INFINITY - 767))
 
 // A simple structure to represent a move.
 struct Move {
@@ -18,6 +43,7 @@ struct Move {
 class GameInterface {
 public:
     // Return an evaluation score for the current board state.
+    // Use +/-SCORE_WIN for positions that are won or lost.
     virtual int evaluateBoard() = 0;
     
     // Populate the moves array with legal moves from the current state.
@@ -39,6 +65,52 @@ public:
     // Optional: If the game supports an optimal opening move, override this method.
     // The default implementation does nothing.
     virtual bool optimalOpeningMove(Move & /*move*/) { return false; }
+
+    // Optional copy-make support. A game whose whole state is a small,
+    // trivially copyable struct returns its size here and a pointer to it
+    // from stateData(). The engine then copies the state before each move
+    // and copies it back instead of calling undoMove().
+    // The default of 0 keeps the applyMove/undoMove protocol.
+    virtual uint8_t stateSize() { return 0; }
+    virtual void *stateData() { return nullptr; }
+
+    // Optional: a 32-bit key identifying the current position (including
+    // anything that changes the legal moves, such as the side to move).
+    // Needed to use a TranspositionTable. The default reports no key.
+    virtual bool positionKey(uint32_t & /*key*/) { return false; }
+
+    // Optional: advance the state by a move without recording undo
+    // information. Only used in copy-make mode; defaults to applyMove().
+    virtual void makeMove(const Move &m) { applyMove(m); }
+
+    // Optional symmetry support, for games whose rotated or reflected
+    // positions have the same score. Return a key that is equal for every
+    // position in a symmetry class (otherwise like positionKey()), and the
+    // transform that maps the current position onto the class's canonical
+    // one. The engine then searches only one move of each group of
+    // symmetric moves and shares table entries between symmetric positions.
+    // The default reports no symmetry.
+    virtual bool canonicalKey(uint32_t & /*key*/, uint8_t & /*transform*/) { return false; }
+
+    // Map a move through a transform from canonicalKey(), or back if
+    // inverse is true.
+    virtual Move transformMove(const Move &m, uint8_t /*transform*/, bool /*inverse*/) { return m; }
+
+    // Return true if a transform other than the identity maps the current
+    // position onto itself. The engine only looks for symmetric moves in
+    // such positions, as elsewhere they are rare and the check costs a
+    // move and a key per move.
+    virtual bool isSymmetric() { return false; }
+
+    // Optional frontier batching. Write the evaluateBoard() score of the
+    // position after each of the count moves (legal in the current
+    // position) to scores, leaving the game as it was. At a node one ply
+    // above its search horizon, the engine scores the first child as usual
+    // and, unless that cuts the node off, hands all the others to this in
+    // one call, so a game can score them together (with SIMD, say). Return
+    // false if not supported (the default); the engine then scores each
+    // child with evaluateBoard().
+    virtual bool evaluateMoves(const Move * /*moves*/, uint8_t /*count*/, int * /*scores*/) { return false; }
 };
 
 #endif // GAME_INTERFACE_H
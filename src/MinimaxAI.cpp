@@ -1,98 +1,548 @@
 #include "MinimaxAI.h"
 
+constexpr size_t MinimaxAI::SEARCH_STACK_BYTES;
+
 MinimaxAI::MinimaxAI(GameInterface &gameRef, uint8_t depth)
-    : game(&gameRef), maxDepth(depth) {
+    : game(&gameRef), maxDepth(depth > MINIMAX_MAX_PLY ? MINIMAX_MAX_PLY : depth), bestMove({0, 0}), bestScore(0), ply(0), rootPly(0), searching(false), nodes(0),
+      pondering(false), ponderPrediction({0, 0}), ponderReply({0, 0}), ponderReplyValid(false),
+      symmetric(false), batchLeaves(false), table(nullptr)
+#ifdef MINIMAX_TRACE
+      , traceSink(nullptr), traceContext(nullptr), traceRootMove({0, 0})
+#endif
+{
+#ifdef MINIMAX_PROFILE
+    profile.clear();
+#endif
+}
+
+uint8_t MinimaxAI::getDepth() const {
+    return maxDepth;
+}
+
+void MinimaxAI::setDepth(uint8_t depth) {
+    maxDepth = (depth > MINIMAX_MAX_PLY ? MINIMAX_MAX_PLY : depth);
 }
 
 Move MinimaxAI::findBestMove() {
+    startSearch();
+    while (!stepSearch(0xFFFF)) {
+    }
+    return bestMove;
+}
+
+uint8_t MinimaxAI::findBestMoves(ScoredMove *results, uint8_t k) {
+    cancelSearch();
+    nodes = 0;
+    ponderReplyValid = false;
+    prepareState();
+#ifdef MINIMAX_PROFILE
+    profile.clear();
+#endif
+    PROFILE_SCOPE(PROFILE_SEARCH);
+
+    bool maximizing = (game->currentPlayer() > 0);
+    Move moves[MAX_MOVES];
+    uint8_t moveCount = generateMoves(moves);
+    uint8_t found = 0;
+    // searchWindow() saves its plies in slots 0 to maxDepth - 2, so the
+    // root state goes in the last slot and is copied back after each move.
+    uint8_t rootSlot = (maxDepth > 1) ? maxDepth - 1 : 0;
+
+    for (uint8_t i = 0; i < moveCount && k > 0; i++) {
+        // Once k moves are known, a move only matters if it beats the k-th best,
+        // so search it with the window opened at that score. Anything that
+        // fails low is not in the top k; anything inside the window is exact.
+        Score bound = (found == k) ? results[k - 1].score : (maximizing ? -SCORE_INFINITY : SCORE_INFINITY);
+        Score score;
+
+        nodes++;
+        makeMove(rootSlot, moves[i]);
+        if (maxDepth <= 1 || isGameOver()) {
+            score = leafScore(evaluateBoard(), 1);
+        } else if (maximizing) {
+#ifdef MINIMAX_TRACE
+            traceRootMove = moves[i];
+#endif
+            score = searchWindow(maxDepth - 1, bound, SCORE_INFINITY);
+        } else {
+#ifdef MINIMAX_TRACE
+            traceRootMove = moves[i];
+#endif
+            score = searchWindow(maxDepth - 1, -SCORE_INFINITY, bound);
+        }
+        unmakeMove(rootSlot, moves[i]);
+
+        if (found == k && (maximizing ? score <= bound : score >= bound)) {
+            continue;
+        }
+
+        // Insert in order, dropping the k-th best if the list is full.
+        uint8_t pos = (found < k) ? found++ : k - 1;
+        while (pos > 0 && (maximizing ? score > results[pos - 1].score : score < results[pos - 1].score)) {
+            results[pos] = results[pos - 1];
+            pos--;
+        }
+        results[pos].move = moves[i];
+        results[pos].score = score;
+    }
+
+    bestMove = (found > 0) ? results[0].move : Move{0, 0};
+    bestScore = (found > 0) ? results[0].score : 0;
+#ifdef MINIMAX_TRACE
+    if (traceSink != nullptr) {
+        // The root moves were searched as separate windows; close the search
+        // with a root record as findBestMove() does.
+        TraceRecord record;
+        record.nodes = nodes + 1;
+        record.alphaIn = record.alphaOut = -SCORE_INFINITY;
+        record.betaIn = record.betaOut = SCORE_INFINITY;
+        record.score = bestScore;
+        record.move = {0xFF, 0xFF};
+        record.ply = 0;
+        record.count = moveCount;
+        record.cutoff = 0xFF;
+        traceSink(record, traceContext);
+    }
+#endif
+    return found;
+}
+
+void MinimaxAI::startSearch() {
+    cancelSearch();
+    nodes = 0;
+    bestMove = {0, 0};
+    bestScore = 0;
+    ponderReplyValid = false;
+#ifdef MINIMAX_PROFILE
+    profile.clear();
+#endif
+
     Move optMove;
     // If the game provides an optimal opening move, use it.
     if (game->optimalOpeningMove(optMove)) {
-        return optMove;
+        bestMove = optMove;
+        return;
     }
 
-    bool maximizing = (game->currentPlayer() > 0);
-    int alpha = -32767;  // Represents -∞.
-    int beta  =  32767;  // Represents +∞.
+    prepareState();
+    ply = 0;
+    rootPly = 0;
+    pushFrame(-SCORE_INFINITY, SCORE_INFINITY);  // Window of -∞ to +∞.
+    searching = true;
+}
 
-    int bestVal = (maximizing ? -32767 : 32767);
-    Move bestMoveCandidate = {0, 0};
+bool MinimaxAI::stepSearch(uint16_t nodeBudget) {
+    PROFILE_SCOPE(PROFILE_SEARCH);
+    return runSearch(nodeBudget);
+}
 
-    Move moves[MAX_MOVES];
-    uint8_t moveCount = game->generateMoves(moves);
+bool MinimaxAI::runSearch(uint16_t nodeBudget) {
+    // Between steps the game rests at the searched position.
+    // Replay the path down to the active frame before continuing.
+    for (uint8_t p = 0; p < ply; p++) {
+        makeMove(p, frames[p].moves[frames[p].index]);
+    }
 
-    for (uint8_t i = 0; i < moveCount; i++) {
-        game->applyMove(moves[i]);
-        int eval = minimaxRecursive(maxDepth - 1, alpha, beta, !maximizing);
-        game->undoMove(moves[i]);
+    while (searching) {
+        SearchFrame &frame = frames[ply];
 
-        if (maximizing) {
-            if (eval > bestVal) {
-                bestVal = eval;
-                bestMoveCandidate = moves[i];
+        if (frame.index >= frame.count) {
+            // Every move at this ply has been searched (or cut off).
+            if (table != nullptr && frame.count > 0) {
+                storeFrame(frame);
+            }
+#ifdef MINIMAX_TRACE
+            if (traceSink != nullptr) {
+                traceFrame(frame);
+            }
+#endif
+            if (ply == 0) {
+                bestMove = frame.bestMove;
+                bestScore = frame.best;
+                searching = false;
+                break;
             }
-            if (eval > alpha) {
-                alpha = eval;
+            Score score = frame.best;
+            SearchFrame &parent = frames[--ply];
+            unmakeMove(ply, parent.moves[parent.index]);
+            if (backUp(parent, score) && ply == 0) {
+                // Remember the reply we expect if this root move is played.
+                ponderReply = frame.bestMove;
+                ponderReplyValid = (frame.count > 0);
             }
-        } else { // Minimizing.
-            if (eval < bestVal) {
-                bestVal = eval;
-                bestMoveCandidate = moves[i];
+            continue;
+        }
+
+        if (nodeBudget == 0) {
+            // Out of budget: take the path back so the game is at the searched position.
+            for (uint8_t p = ply; p > 0; p--) {
+                unmakeMove(p - 1, frames[p - 1].moves[frames[p - 1].index]);
             }
-            if (eval < beta) {
-                beta = eval;
+            return false;
+        }
+
+        // Frontier: every child is a leaf, so let the game score all the
+        // remaining ones at once. The scores are then backed up in move
+        // order exactly as if each child had been searched on its own.
+        // The first child goes alone, as it often cuts the rest off.
+        uint8_t left = frame.count - frame.index;
+        if (batchLeaves && ply + 1 >= maxDepth && frame.index > 0 && left <= nodeBudget) {
+            int scores[MAX_MOVES];
+            if (evaluateMoves(&frame.moves[frame.index], left, scores)) {
+                for (uint8_t i = 0; i < left && frame.index < frame.count; i++) {
+                    nodeBudget--;
+                    nodes++;
+                    if (backUp(frame, leafScore(scores[i], rootPly + ply + 1)) && ply == 0) {
+                        ponderReplyValid = false;
+                    }
+                }
+                continue;
             }
+            batchLeaves = false;  // Not supported by the game: stop asking.
         }
-        if (alpha >= beta) {
-            break;  // Alpha-beta cutoff.
+        nodeBudget--;
+        nodes++;
+
+        makeMove(ply, frame.moves[frame.index]);
+        uint8_t childPly = ply + 1;
+        if (childPly >= maxDepth || isGameOver()) {
+            Score score = leafScore(evaluateBoard(), rootPly + childPly);
+            unmakeMove(ply, frame.moves[frame.index]);
+            if (backUp(frame, score) && ply == 0) {
+                ponderReplyValid = false;
+            }
+        } else {
+            ply = childPly;
+            pushFrame(frame.alpha, frame.beta);
         }
     }
-    return bestMoveCandidate;
+    return true;
+}
+
+bool MinimaxAI::isSearching() const {
+    return searching;
+}
+
+Move MinimaxAI::getResult() const {
+    return bestMove;
+}
+
+Score MinimaxAI::getScore() const {
+    return bestScore;
 }
 
-int MinimaxAI::minimaxRecursive(uint8_t depth, int alpha, int beta, bool maximizing) {
-    if (depth == 0 || game->isGameOver()) {
-        return game->evaluateBoard();
+void MinimaxAI::cancelSearch() {
+    // The game is already back at the searched position between steps.
+    searching = false;
+    ply = 0;
+    if (pondering) {
+        game->undoMove(ponderPrediction);
+        pondering = false;
     }
+}
 
-    Move moves[MAX_MOVES];
-    uint8_t moveCount = game->generateMoves(moves);
+bool MinimaxAI::getPonderMove(Move &move) const {
+    if (searching || !ponderReplyValid) {
+        return false;
+    }
+    move = ponderReply;
+    return true;
+}
 
-    if (maximizing) {
-        int maxScore = -32767;
-        for (uint8_t i = 0; i < moveCount; i++) {
-            game->applyMove(moves[i]);
-            int score = minimaxRecursive(depth - 1, alpha, beta, false);
-            game->undoMove(moves[i]);
+void MinimaxAI::startPonder(const Move &predicted) {
+    cancelSearch();
+    game->applyMove(predicted);
+    startSearch();
+    ponderPrediction = predicted;
+    pondering = true;
+}
 
-            if (score > maxScore) {
-                maxScore = score;
-            }
-            if (score > alpha) {
-                alpha = score;
-            }
-            if (alpha >= beta) {
-                break;
-            }
-        }
-        return maxScore;
+bool MinimaxAI::isPondering() const {
+    return pondering;
+}
+
+bool MinimaxAI::ponderHit(const Move &played) {
+    if (!pondering) {
+        return false;
+    }
+    if (played.from == ponderPrediction.from && played.to == ponderPrediction.to) {
+        // Keep the search: it is already working on the position after this move.
+        pondering = false;
+        return true;
+    }
+    cancelSearch();
+    return false;
+}
+
+uint32_t MinimaxAI::getNodeCount() const {
+    return nodes;
+}
+
+void MinimaxAI::setTranspositionTable(TranspositionTable *tableRef) {
+    table = tableRef;
+}
+
+#ifdef MINIMAX_PROFILE
+const SearchProfile &MinimaxAI::getProfile() const {
+    return profile;
+}
+
+void MinimaxAI::printProfile() const {
+    profile.print();
+}
+#endif
+
+#ifdef MINIMAX_TRACE
+void MinimaxAI::setTraceSink(TraceSink sink, void *context) {
+    traceSink = sink;
+    traceContext = context;
+}
+
+void MinimaxAI::traceFrame(const SearchFrame &frame) {
+    TraceRecord record;
+    record.nodes = nodes - frame.nodesIn + 1;
+    record.alphaIn = frame.alphaIn;
+    record.betaIn = frame.betaIn;
+    record.alphaOut = frame.alpha;
+    record.betaOut = frame.beta;
+    record.score = frame.best;
+    if (ply > 0) {
+        record.move = frames[ply - 1].moves[frames[ply - 1].index];
     } else {
-        int minScore = 32767;
-        for (uint8_t i = 0; i < moveCount; i++) {
-            game->applyMove(moves[i]);
-            int score = minimaxRecursive(depth - 1, alpha, beta, true);
-            game->undoMove(moves[i]);
-
-            if (score < minScore) {
-                minScore = score;
+        record.move = (rootPly > 0) ? traceRootMove : Move{0xFF, 0xFF};
+    }
+    record.ply = rootPly + ply;
+    record.count = frame.count;
+    record.cutoff = frame.cutoff;
+    traceSink(record, traceContext);
+}
+#endif
+
+void MinimaxAI::prepareState() {
+    states.prepare(game, maxDepth);
+    uint32_t key;
+    uint8_t transform;
+    symmetric = game->canonicalKey(key, transform);
+    batchLeaves = true;  // Until the game says otherwise.
+}
+
+Score MinimaxAI::searchWindow(uint8_t depth, Score alpha, Score beta) {
+    uint8_t fullDepth = maxDepth;
+    maxDepth = depth;
+    ply = 0;
+    rootPly = 1;
+    pushFrame(alpha, beta);
+    searching = true;
+    while (!runSearch(0xFFFF)) {
+    }
+    maxDepth = fullDepth;
+    return frames[0].best;
+}
+
+void MinimaxAI::setStateBuffer(void *buffer, uint16_t bytes) {
+    states.setBuffer(buffer, bytes);
+}
+
+uint8_t MinimaxAI::generateMoves(Move *moves) {
+    PROFILE_SCOPE(PROFILE_GENERATE);
+    return game->generateMoves(moves);
+}
+
+int MinimaxAI::evaluateBoard() {
+    PROFILE_SCOPE(PROFILE_EVALUATE);
+    return game->evaluateBoard();
+}
+
+bool MinimaxAI::evaluateMoves(const Move *moves, uint8_t count, int *scores) {
+    PROFILE_SCOPE(PROFILE_BATCH);
+    bool scored = game->evaluateMoves(moves, count, scores);
+    // One call per board, so the row reads like the evaluateBoard() one.
+    PROFILE_CALLS(scored ? count : 0);
+    return scored;
+}
+
+bool MinimaxAI::isGameOver() {
+    PROFILE_SCOPE(PROFILE_GAME_OVER);
+    return game->isGameOver();
+}
+
+bool MinimaxAI::tableKey(uint32_t &key, uint8_t &transform) {
+    PROFILE_SCOPE(PROFILE_KEY);
+    if (symmetric) {
+        return game->canonicalKey(key, transform);
+    }
+    transform = 0;
+    return game->positionKey(key);
+}
+
+void MinimaxAI::removeSymmetricMoves(SearchFrame &frame) {
+    // Symmetric children have equal canonical keys and equal scores, so all
+    // but the first of them can be dropped without changing the result.
+    uint32_t keys[MAX_MOVES];
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < frame.count; i++) {
+        uint32_t key;
+        uint8_t transform;
+        makeMove(ply, frame.moves[i]);
+        tableKey(key, transform);
+        unmakeMove(ply, frame.moves[i]);
+        uint8_t j = 0;
+        while (j < kept && keys[j] != key) {
+            j++;
+        }
+        if (j == kept) {
+            keys[kept] = key;
+            frame.moves[kept++] = frame.moves[i];
+        }
+    }
+    frame.count = kept;
+}
+
+void MinimaxAI::makeMove(uint8_t atPly, const Move &m) {
+    PROFILE_SCOPE(PROFILE_APPLY);
+    states.makeMove(atPly, m);
+}
+
+void MinimaxAI::unmakeMove(uint8_t atPly, const Move &m) {
+    PROFILE_SCOPE(PROFILE_UNDO);
+    states.unmakeMove(atPly, m);
+}
+
+Score MinimaxAI::leafScore(int eval, uint8_t atPly) const {
+    // Won and lost positions score by distance, so faster wins rank higher.
+    if (eval >= SCORE_WIN) return SCORE_WIN - atPly;
+    if (eval <= -SCORE_WIN) return -SCORE_WIN + atPly;
+    // Keep heuristic scores clear of the win range.
+    const int limit = SCORE_WIN - MINIMAX_MAX_PLY - 1;
+    if (eval > limit) return limit;
+    if (eval < -limit) return -limit;
+    return eval;
+}
+
+void MinimaxAI::pushFrame(Score alpha, Score beta) {
+    SearchFrame &frame = frames[ply];
+    // Ask the game whose turn it is: a side may move again (multi-jumps),
+    // so plies do not simply alternate.
+    bool maximizing = (game->currentPlayer() > 0);
+    frame.index = 0;
+    frame.maximizing = maximizing;
+    frame.best = (maximizing ? -SCORE_INFINITY : SCORE_INFINITY);
+    frame.bestMove = {0, 0};
+#ifdef MINIMAX_TRACE
+    frame.nodesIn = nodes;
+    frame.cutoff = 0xFF;
+    frame.alphaIn = alpha;
+    frame.betaIn = beta;
+#endif
+
+    // Mate-distance pruning: nothing below this ply can score better than a
+    // win on the very next ply. If a faster win is already known for either
+    // side, this position cannot change the result and is not searched.
+    Score mateBound = SCORE_WIN - (rootPly + ply + 1);
+    if (alpha >= mateBound) {
+        frame.count = 0;
+        frame.best = mateBound;
+        return;
+    }
+    if (beta <= -mateBound) {
+        frame.count = 0;
+        frame.best = -mateBound;
+        return;
+    }
+    alpha = (alpha < -mateBound) ? -mateBound : alpha;
+    beta = (beta > mateBound) ? mateBound : beta;
+    frame.alpha = frame.alphaIn = alpha;
+    frame.beta = frame.betaIn = beta;
+
+    // Reuse a stored result for this position if it was searched deep enough.
+    Move hashMove = {0, 0};
+    bool haveHashMove = false;
+    uint32_t key;
+    uint8_t transform;
+    if (table != nullptr && tableKey(key, transform)) {
+        uint8_t depth;
+        TTBound bound;
+        Score score;
+        if (table->probe(key, depth, bound, score, hashMove)) {
+            haveHashMove = true;
+            if (symmetric) {
+                hashMove = game->transformMove(hashMove, transform, true);
             }
-            if (score < beta) {
-                beta = score;
+            // Win scores are stored relative to this position.
+            if (score > SCORE_WIN - MINIMAX_MAX_PLY - 1) score -= rootPly + ply;
+            else if (score < -(SCORE_WIN - MINIMAX_MAX_PLY - 1)) score += rootPly + ply;
+            if (ply > 0 && depth >= maxDepth - ply &&
+                (bound == TT_EXACT || (bound == TT_LOWER && score >= beta) || (bound == TT_UPPER && score <= alpha))) {
+                frame.count = 0;
+                frame.best = score;
+                return;
             }
-            if (alpha >= beta) {
+        }
+    }
+
+    frame.count = generateMoves(frame.moves);
+
+    // Search the stored best move first.
+    if (haveHashMove) {
+        for (uint8_t i = 1; i < frame.count; i++) {
+            if (frame.moves[i].from == hashMove.from && frame.moves[i].to == hashMove.to) {
+                frame.moves[i] = frame.moves[0];
+                frame.moves[0] = hashMove;
                 break;
             }
         }
-        return minScore;
     }
+
+    if (symmetric && frame.count > 1 && game->isSymmetric()) {
+        removeSymmetricMoves(frame);
+    }
+}
+
+void MinimaxAI::storeFrame(const SearchFrame &frame) {
+    uint32_t key;
+    uint8_t transform;
+    if (!tableKey(key, transform)) {
+        return;
+    }
+    TTBound bound = TT_EXACT;
+    if (frame.best <= frame.alphaIn) bound = TT_UPPER;
+    else if (frame.best >= frame.betaIn) bound = TT_LOWER;
+    // Store win scores relative to this position.
+    Score score = frame.best;
+    if (score > SCORE_WIN - MINIMAX_MAX_PLY - 1) score += rootPly + ply;
+    else if (score < -(SCORE_WIN - MINIMAX_MAX_PLY - 1)) score -= rootPly + ply;
+    // Moves are stored in the frame of the canonical position.
+    Move move = symmetric ? game->transformMove(frame.bestMove, transform, false) : frame.bestMove;
+    table->store(key, maxDepth - ply, bound, score, move);
+}
+
+bool MinimaxAI::backUp(SearchFrame &frame, Score score) {
+    bool improved = false;
+    if (frame.maximizing) {
+        if (score > frame.best) {
+            frame.best = score;
+            frame.bestMove = frame.moves[frame.index];
+            improved = true;
+        }
+        if (score > frame.alpha) {
+            frame.alpha = score;
+        }
+    } else { // Minimizing.
+        if (score < frame.best) {
+            frame.best = score;
+            frame.bestMove = frame.moves[frame.index];
+            improved = true;
+        }
+        if (score < frame.beta) {
+            frame.beta = score;
+        }
+    }
+    frame.index++;
+    if (frame.alpha >= frame.beta) {
+#ifdef MINIMAX_TRACE
+        frame.cutoff = frame.index - 1;
+#endif
+        frame.index = frame.count;  // Alpha-beta cutoff.
+    }
+    return improved;
 }
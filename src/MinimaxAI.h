@@ -2,23 +2,251 @@
 #define MINIMAX_AI_H
 
 #include "GameInterface.h"
+#include "TranspositionTable.h"
+#include "PlyStates.h"
+#include "SearchProfile.h"
+
+// Maximum number of plies the search can hold. A larger search depth is
+// clamped to this value, so the search never runs past its stack.
+// Like MAX_MOVES, override it with a compiler flag so the library and the
+// sketch see the same value.
+#ifndef MINIMAX_MAX_PLY
+#define MINIMAX_MAX_PLY 10
+#endif
+
+// Define MINIMAX_TRACE (as a compiler flag, like MINIMAX_MAX_PLY) to build
+// the search with tracing support; see MinimaxAI::setTraceSink(). Without it
+// the search carries no tracing code or state.
+
+// One ply of the search: the move list and the alpha-beta state needed to
+// continue the loop over its moves at a later time. All plies live in one
+// statically sized array inside MinimaxAI; the search does not recurse.
+struct SearchFrame {
+    Move moves[MAX_MOVES];  // Moves generated at this ply
+    uint8_t count;          // Number of moves in the list
+    uint8_t index;          // Move currently being searched
+    bool maximizing;        // True if the side to move is maximizing
+    Score alpha;
+    Score beta;
+    Score alphaIn;          // Window the ply was entered with
+    Score betaIn;
+    Score best;             // Best score found so far at this ply
+    Move bestMove;          // Move that produced the best score
+#ifdef MINIMAX_TRACE
+    uint32_t nodesIn;       // Node count when the ply was entered
+    uint8_t cutoff;         // Index of the move that caused a cutoff, or 0xFF
+#endif
+};
+
+// A root move together with its exact search score.
+struct ScoredMove {
+    Move move;
+    Score score;
+};
+
+#ifdef MINIMAX_TRACE
+// One searched interior node, reported when its search completes. Children
+// are reported before their parent, so the search root comes last; a
+// findBestMoves() search also ends with a root record (ply 0).
+struct TraceRecord {
+    uint32_t nodes;   // Nodes in the subtree, this node included
+    Score alphaIn;    // Window the node was searched with
+    Score betaIn;
+    Score alphaOut;   // Window when its search ended
+    Score betaOut;
+    Score score;      // Result of the node
+    Move move;        // Move that led to the node ({0xFF, 0xFF} at the search root)
+    uint8_t ply;      // Distance from the searched position
+    uint8_t count;    // Moves generated (0 if the node was cut off by the table or a known win)
+    uint8_t cutoff;   // Index of the move that caused a beta cutoff, or 0xFF if none
+};
+
+// Receives trace records; context is the pointer given to setTraceSink().
+typedef void (*TraceSink)(const TraceRecord &record, void *context);
+#endif
 
 // The MinimaxAI class encapsulates the minimax search with alpha-beta pruning.
+//
+// The search can be run to completion with findBestMove(), or cooperatively
+// from the Arduino loop() with startSearch() / stepSearch() so that the rest
+// of the sketch keeps running while the engine thinks. Between calls to
+// stepSearch() the game is back at the searched position: the sketch may
+// read it, but must not change it until the search completes or is cancelled.
 class MinimaxAI {
 public:
+    // SRAM used by the search stack, fixed at compile time.
+    static constexpr size_t SEARCH_STACK_BYTES = sizeof(SearchFrame) * MINIMAX_MAX_PLY;
+
     // Constructor takes a reference to a GameInterface instance and the maximum search depth.
+    // Depths beyond MINIMAX_MAX_PLY are clamped; see getDepth().
     MinimaxAI(GameInterface &gameRef, uint8_t depth);
 
+    // The search depth actually used.
+    uint8_t getDepth() const;
+
+    // Change the search depth for the next search (clamped like the constructor's).
+    void setDepth(uint8_t depth);
+
     // Finds and returns the best move for the current game state.
     Move findBestMove();
 
+    // Multi-PV analysis: finds up to k of the best moves for the current game
+    // state with exact scores and writes them to results, best first.
+    // Returns the number of moves written.
+    uint8_t findBestMoves(ScoredMove *results, uint8_t k);
+
+    // Begin a search of the current game state.
+    void startSearch();
+
+    // Search at most nodeBudget more nodes.
+    // Returns true once the search is complete and getResult() is valid.
+    bool stepSearch(uint16_t nodeBudget);
+
+    // Returns true while a started search has not yet completed.
+    bool isSearching() const;
+
+    // The best move found by the last completed search.
+    Move getResult() const;
+
+    // The score of that move.
+    Score getScore() const;
+
+    // Abandon the current search (including a ponder search) and restore
+    // the game to the position the search was started from.
+    void cancelSearch();
+
+    // The opponent reply the engine expects after its last completed search.
+    // Returns false if no reply is known (for example, a depth 1 search).
+    bool getPonderMove(Move &move) const;
+
+    // Apply the predicted opponent move and start searching the resulting
+    // position while the opponent is thinking. Step it with stepSearch().
+    void startPonder(const Move &predicted);
+
+    // Returns true while a ponder search is active (running or complete).
+    bool isPondering() const;
+
+    // Report the move the opponent actually played.
+    // On a hit (returns true) the predicted move stays applied to the game and
+    // the ponder search continues as the engine's normal search.
+    // On a miss (returns false) the ponder search is discarded, the predicted
+    // move is taken back, and the caller applies the played move itself.
+    bool ponderHit(const Move &played);
+
+    // Number of nodes visited by the current or last search.
+    uint32_t getNodeCount() const;
+
+    // Enable copy-make search for games that expose their state (see
+    // GameInterface::stateSize()). The buffer must hold one state per ply
+    // of the search depth, otherwise applyMove/undoMove are used.
+    void setStateBuffer(void *buffer, uint16_t bytes);
+
+    // Use a transposition table to reuse results for repeated positions and
+    // to search the stored best move first. Needs GameInterface::positionKey().
+    // Several engines may share one table. Pass nullptr to stop using it.
+    void setTranspositionTable(TranspositionTable *table);
+
+#ifdef MINIMAX_PROFILE
+    // Calls and time per GameInterface hook for the current or last search.
+    // stepSearch() calls count as search time; time between them does not.
+    const SearchProfile &getProfile() const;
+
+    // Print that breakdown to Serial.
+    void printProfile() const;
+#endif
+
+#ifdef MINIMAX_TRACE
+    // Report every completed interior node to sink, for example to append
+    // records to a buffer or a file. Pass nullptr to stop tracing.
+    void setTraceSink(TraceSink sink, void *context);
+#endif
+
 private:
-    // The recursive minimax function with alpha-beta pruning.
-    int minimaxRecursive(uint8_t depth, int alpha, int beta, bool maximizing);
+    // Advance the search by up to nodeBudget nodes (see stepSearch()).
+    bool runSearch(uint16_t nodeBudget);
+
+    // The GameInterface calls made by the search, timed per hook when
+    // MINIMAX_PROFILE is defined.
+    uint8_t generateMoves(Move *moves);
+    int evaluateBoard();
+    bool evaluateMoves(const Move *moves, uint8_t count, int *scores);
+    bool isGameOver();
+
+    // The key to look the position up with in the table, and the transform
+    // that maps its moves into the table's frame (0 without symmetry).
+    bool tableKey(uint32_t &key, uint8_t &transform);
+
+    // Keep one move of each group of moves that lead to symmetric positions.
+    void removeSymmetricMoves(SearchFrame &frame);
+
+    // Decide whether this search can use copy-make, symmetry and frontier
+    // batching.
+    void prepareState();
+
+    // Search the current position to the given depth within (alpha, beta)
+    // and return its score.
+    Score searchWindow(uint8_t depth, Score alpha, Score beta);
+
+    // Convert a game evaluation at a ply into a search score.
+    Score leafScore(int eval, uint8_t atPly) const;
+
+    // Generate the moves for the frame at the current ply, for the side the
+    // game reports to move. Positions that cannot beat a known faster win
+    // are not searched.
+    void pushFrame(Score alpha, Score beta);
+
+    // Play / take back the move searched at a ply, using copy-make when enabled.
+    void makeMove(uint8_t atPly, const Move &m);
+    void unmakeMove(uint8_t atPly, const Move &m);
+
+    // Save the result of a completed frame in the transposition table.
+    void storeFrame(const SearchFrame &frame);
+
+    // Fold a child score into a frame and advance to its next move.
+    // Returns true if the score became the frame's best.
+    bool backUp(SearchFrame &frame, Score score);
 
     GameInterface *game;   // Pointer to the game object
     uint8_t maxDepth;      // Maximum search depth
     Move bestMove;         // Best move found during search
+    Score bestScore;       // Score of bestMove
+
+    SearchFrame frames[MINIMAX_MAX_PLY];  // Explicit search stack
+    uint8_t ply;           // Index of the active frame
+    uint8_t rootPly;       // Distance of frame 0 from the real root (for win distances)
+    bool searching;        // True while a search is in progress
+    uint32_t nodes;        // Nodes visited by the current search
+
+    bool pondering;        // True while searching on the opponent's time
+    Move ponderPrediction; // Opponent move applied for the ponder search
+    Move ponderReply;      // Expected reply to bestMove
+    bool ponderReplyValid;
+
+    PlyStates states;      // Copy-make buffer (optional)
+    bool symmetric;        // The game reports symmetric positions
+    bool batchLeaves;      // The game scores frontier children in one call
+
+    TranspositionTable *table;  // Optional cache of search results
+
+#ifdef MINIMAX_PROFILE
+    SearchProfile profile;
+#endif
+
+#ifdef MINIMAX_TRACE
+    // Report the completed frame at the current ply.
+    void traceFrame(const SearchFrame &frame);
+
+    TraceSink traceSink;
+    void *traceContext;
+    Move traceRootMove;    // Root move a findBestMoves() window search is under
+#endif
 };
 
+// Define MINIMAX_STACK_BUDGET (in bytes) before including this header to
+// fail the build if the search stack would not fit.
+#ifdef MINIMAX_STACK_BUDGET
+static_assert(MinimaxAI::SEARCH_STACK_BYTES <= MINIMAX_STACK_BUDGET,
+              "MinimaxAI search stack exceeds MINIMAX_STACK_BUDGET; lower MINIMAX_MAX_PLY or MAX_MOVES");
+#endif
+
 #endif // MINIMAX_AI_H
@@ -0,0 +1,102 @@
+#include "MinimaxBatch.h"
+
+#if !defined(ARDUINO)
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+void analyzePosition(MinimaxAI &ai, uint8_t maxDepth, uint32_t nodeBudget, BatchResult &result) {
+    result.bestMove = {0, 0};
+    result.score = 0;
+    result.depth = 0;
+    result.nodes = 0;
+
+    // The search cannot go deeper than its stack.
+    if (maxDepth > MINIMAX_MAX_PLY) {
+        maxDepth = MINIMAX_MAX_PLY;
+    }
+    for (uint8_t depth = 1; depth <= maxDepth; depth++) {
+        ai.setDepth(depth);
+        ai.startSearch();
+        bool complete = false;
+        for (;;) {
+            uint32_t used = result.nodes + ai.getNodeCount();
+            if (nodeBudget != 0 && used >= nodeBudget) {
+                break;
+            }
+            uint32_t left = (nodeBudget == 0) ? 0xFFFF : nodeBudget - used;
+            if (ai.stepSearch(left > 0xFFFF ? 0xFFFF : (uint16_t)left)) {
+                complete = true;
+                break;
+            }
+        }
+        result.nodes += ai.getNodeCount();
+        if (!complete) {
+            ai.cancelSearch();
+            break;
+        }
+        result.bestMove = ai.getResult();
+        result.score = ai.getScore();
+        result.depth = depth;
+    }
+}
+
+BatchStats analyzeBatch(GameInterface *const *games, uint8_t threadCount,
+                        const void *positions, uint32_t count,
+                        uint8_t maxDepth, uint32_t nodeBudget,
+                        TranspositionTable *sharedTable, BatchResult *results) {
+    BatchStats stats = {0, 0, 0, 0, 0};
+    if (threadCount == 0) {
+        return stats;
+    }
+    // Positions are loaded by copying states, so every game must have one.
+    for (uint8_t t = 0; t < threadCount; t++) {
+        if (games[t]->stateSize() == 0 || games[t]->stateData() == nullptr) {
+            return stats;
+        }
+    }
+
+    std::atomic<uint32_t> next(0);
+    std::vector<uint64_t> threadNodes(threadCount, 0);
+    auto start = std::chrono::steady_clock::now();
+
+    auto worker = [&](uint8_t t) {
+        GameInterface *game = games[t];
+        uint8_t stateBytes = game->stateSize();
+        const uint8_t *states = (const uint8_t *)positions;
+        std::vector<uint8_t> plyStates((size_t)stateBytes * MINIMAX_MAX_PLY);
+
+        MinimaxAI ai(*game, maxDepth);
+        ai.setStateBuffer(plyStates.data(), (uint16_t)plyStates.size());
+        ai.setTranspositionTable(sharedTable);
+
+        // Threads take the next unanalyzed position until none are left.
+        for (uint32_t i = next++; i < count; i = next++) {
+            memcpy(game->stateData(), states + (size_t)i * stateBytes, stateBytes);
+            analyzePosition(ai, maxDepth, nodeBudget, results[i]);
+            threadNodes[t] += results[i].nodes;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (uint8_t t = 1; t < threadCount; t++) {
+        pool.emplace_back(worker, t);
+    }
+    worker(0);
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+
+    stats.positions = count;
+    for (uint64_t n : threadNodes) {
+        stats.nodes += n;
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stats.positionsPerSecond = (stats.seconds > 0) ? count / stats.seconds : 0;
+    stats.nodesPerSecond = (stats.seconds > 0) ? stats.nodes / stats.seconds : 0;
+    return stats;
+}
+
+#endif // !ARDUINO
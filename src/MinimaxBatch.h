@@ -0,0 +1,52 @@
+#ifndef MINIMAX_BATCH_H
+#define MINIMAX_BATCH_H
+
+// Batch analysis of many positions on a thread pool.
+// Host builds only: it needs threads and is compiled out for Arduino targets.
+#if !defined(ARDUINO)
+
+#include "MinimaxAI.h"
+
+// The result for one analyzed position.
+struct BatchResult {
+    Move bestMove;   // Best move of the deepest completed search
+    Score score;     // Score of that move
+    uint8_t depth;   // Depth completed within the node budget (0 = none)
+    uint32_t nodes;  // Nodes searched for this position
+};
+
+// Throughput of a batch run.
+struct BatchStats {
+    uint32_t positions;
+    uint64_t nodes;
+    double seconds;
+    double positionsPerSecond;
+    double nodesPerSecond;
+};
+
+// Search the game's current position by iterative deepening up to
+// maxDepth (at most MINIMAX_MAX_PLY), stopping once nodeBudget nodes have been used (0 = no limit).
+// The ai keeps its settings, including its transposition table, so a
+// caller that analyzes one position after another keeps its caches warm.
+void analyzePosition(MinimaxAI &ai, uint8_t maxDepth, uint32_t nodeBudget, BatchResult &result);
+
+// Analyze count positions using one thread per game object.
+//
+// games holds threadCount game objects of the same type; each thread
+// searches with its own. The game must support copy-make (stateSize() and
+// stateData()); positions holds count of its states back to back. Games
+// without a state, or no games at all, are rejected: nothing is analyzed
+// and the returned stats report 0 positions.
+//
+// Each position is searched by iterative deepening up to maxDepth, stopping
+// once nodeBudget nodes have been used (0 = no limit). If sharedTable is not
+// null, every thread reads and writes that one table. results must hold
+// count entries and is filled in position order.
+BatchStats analyzeBatch(GameInterface *const *games, uint8_t threadCount,
+                        const void *positions, uint32_t count,
+                        uint8_t maxDepth, uint32_t nodeBudget,
+                        TranspositionTable *sharedTable, BatchResult *results);
+
+#endif // !ARDUINO
+
+#endif // MINIMAX_BATCH_H
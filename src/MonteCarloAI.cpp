@@ -0,0 +1,368 @@
+#include "MonteCarloAI.h"
+#include <math.h>
+
+#if !defined(ARDUINO)
+#include <thread>
+#include <vector>
+
+// Holds the tree lock of a parallel search for the rest of the block.
+class TreeLock {
+public:
+    explicit TreeLock(std::mutex *lockRef) : lock(lockRef) {
+        if (lock != nullptr) lock->lock();
+    }
+    ~TreeLock() {
+        if (lock != nullptr) lock->unlock();
+    }
+
+private:
+    std::mutex *lock;
+};
+#define TREE_LOCK TreeLock treeGuard(treeLock)
+#else
+#define TREE_LOCK
+#endif
+
+// xorshift32: small, fast and good enough to pick playout moves.
+static inline uint32_t nextRandom(uint32_t &state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// The buffer to restore a game's state from, or nullptr if the game
+// cannot use copy-make with it. Saves the current state into it.
+static uint8_t *saveState(GameInterface *playGame, uint8_t *buffer, uint16_t bytes) {
+    uint8_t size = playGame->stateSize();
+    void *data = playGame->stateData();
+    if (buffer == nullptr || data == nullptr || size == 0 || size > bytes) {
+        return nullptr;
+    }
+    memcpy(buffer, data, size);
+    return buffer;
+}
+
+MonteCarloAI::MonteCarloAI(GameInterface &gameRef, MctsNode *pool, uint16_t poolSize)
+    : game(&gameRef), nodes(pool), capacity(poolSize), used(0), poolFull(false), openLeaves(0),
+      iterationLimit(1000), timeLimit(0), startTime(0), iterations(0), seed(0x2545F491UL),
+      searching(false), bestMove({0, 0}), bestValue(0.5f), stateBuffer(nullptr), stateBufferBytes(0)
+#if !defined(ARDUINO)
+      , treeLock(nullptr)
+#endif
+{
+}
+
+void MonteCarloAI::setIterationLimit(uint32_t limit) {
+    iterationLimit = limit;
+}
+
+void MonteCarloAI::setTimeLimit(uint32_t milliseconds) {
+    timeLimit = milliseconds;
+}
+
+void MonteCarloAI::setSeed(uint32_t value) {
+    seed = (value != 0) ? value : 1;  // xorshift never leaves 0
+}
+
+void MonteCarloAI::setStateBuffer(void *buffer, uint16_t bytes) {
+    stateBuffer = (uint8_t *)buffer;
+    stateBufferBytes = bytes;
+}
+
+Move MonteCarloAI::findBestMove() {
+    startSearch();
+    while (!stepSearch(0xFFFF)) {
+    }
+    return bestMove;
+}
+
+void MonteCarloAI::startSearch() {
+    searching = false;
+    iterations = 0;
+    poolFull = false;
+    bestMove = {0, 0};
+    bestValue = 0.5f;
+    startTime = millis();
+
+    nodes[0].visits = 0;
+    nodes[0].points = 0;
+    nodes[0].firstChild = MCTS_UNEXPANDED;
+    nodes[0].childCount = 0;
+    nodes[0].move = {0, 0};
+    used = 1;
+    openLeaves = 1;
+
+    Move moves[MAX_MOVES];
+    // If the game provides an optimal opening move, use it.
+    if (game->optimalOpeningMove(moves[0])) {
+        bestMove = moves[0];
+        return;
+    }
+    if (game->isGameOver()) {
+        return;
+    }
+    uint8_t count = game->generateMoves(moves);
+    if (count <= 1) {
+        // Nothing to decide.
+        bestMove = (count == 1) ? moves[0] : Move{0, 0};
+        return;
+    }
+    if (!expand(0, moves, count)) {
+        bestMove = moves[0];
+        return;
+    }
+    searching = true;
+}
+
+bool MonteCarloAI::stepSearch(uint16_t iterationBudget) {
+    if (!searching) {
+        return true;
+    }
+    uint8_t *saved = saveState(game, stateBuffer, stateBufferBytes);
+    while (iterationBudget > 0 && iterate(game, seed, saved, 0)) {
+        iterationBudget--;
+    }
+    if (!finished()) {
+        return false;
+    }
+    finish();
+    return true;
+}
+
+bool MonteCarloAI::isSearching() const {
+    return searching;
+}
+
+Move MonteCarloAI::getResult() const {
+    return bestMove;
+}
+
+float MonteCarloAI::getValue() const {
+    return bestValue;
+}
+
+uint32_t MonteCarloAI::getIterationCount() const {
+    return iterations;
+}
+
+uint16_t MonteCarloAI::getNodesUsed() const {
+    return used;
+}
+
+#if !defined(ARDUINO)
+Move MonteCarloAI::findBestMoveParallel(GameInterface *const *games, uint8_t threadCount) {
+    startSearch();
+    if (!searching) {
+        return bestMove;
+    }
+
+    std::mutex lock;
+    treeLock = &lock;
+    auto worker = [&](uint8_t t) {
+        GameInterface *playGame = games[t];
+        std::vector<uint8_t> state(playGame->stateSize());
+        uint8_t *saved = saveState(playGame, state.data(), (uint16_t)state.size());
+        uint32_t rng = seed ^ ((t + 1) * 0x9E3779B9UL);
+        if (rng == 0) {
+            rng = 1;
+        }
+        while (iterate(playGame, rng, saved, MCTS_VIRTUAL_LOSS)) {
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (uint8_t t = 1; t < threadCount; t++) {
+        pool.emplace_back(worker, t);
+    }
+    worker(0);
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+    treeLock = nullptr;
+
+    finish();
+    return bestMove;
+}
+#endif
+
+bool MonteCarloAI::iterate(GameInterface *playGame, uint32_t &rng, uint8_t *saved, uint8_t virtualLoss) {
+    MctsPath path;
+    {
+        TREE_LOCK;
+        if (finished()) {
+            return false;
+        }
+        // Count the playout now so that threads never start more than the limit.
+        iterations++;
+        selectPath(path, virtualLoss);
+    }
+
+    // Replay the tree moves. Tree nodes never move once created, so their
+    // moves can be read without the lock.
+    bool copyMake = (saved != nullptr);
+    path.length = 0;
+    for (uint8_t i = 0; i < path.treeLength; i++) {
+        path.movers[i] = (int8_t)playGame->currentPlayer();
+        play(playGame, path, nodes[path.nodes[i + 1]].move, copyMake);
+    }
+
+    // Grow the tree by the leaf's children and step into one of them.
+    Move moves[MAX_MOVES];
+    uint8_t count = 0;
+    if (path.treeLength < MCTS_MAX_PLIES && !playGame->isGameOver()) {
+        count = playGame->generateMoves(moves);
+    }
+    MctsIndex child = MCTS_UNEXPANDED;
+    {
+        TREE_LOCK;
+        MctsIndex leaf = path.nodes[path.treeLength];
+        if (count == 0) {
+            close(leaf);
+        } else if (expand(leaf, moves, count)) {
+            child = bestChild(nodes[leaf]);
+            nodes[child].visits += virtualLoss;
+        }
+    }
+    if (child != MCTS_UNEXPANDED) {
+        path.movers[path.treeLength] = (int8_t)playGame->currentPlayer();
+        path.nodes[++path.treeLength] = child;
+        play(playGame, path, nodes[child].move, copyMake);
+    }
+
+    // Random playout to the end of the game or the ply limit.
+    while (path.length < MCTS_MAX_PLIES && !playGame->isGameOver()) {
+        uint8_t count = playGame->generateMoves(moves);
+        if (count == 0) {
+            break;
+        }
+        play(playGame, path, moves[nextRandom(rng) % count], copyMake);
+    }
+    int eval = playGame->evaluateBoard();
+    int8_t result = (eval > 0) ? 1 : (eval < 0 ? -1 : 0);
+    takeBack(playGame, path, saved);
+
+    TREE_LOCK;
+    backUp(path, result, virtualLoss);
+    return true;
+}
+
+bool MonteCarloAI::finished() const {
+    if (iterationLimit != 0 && iterations >= iterationLimit) {
+        return true;
+    }
+    if (timeLimit != 0 && millis() - startTime >= timeLimit) {
+        return true;
+    }
+    return iterationLimit == 0 && timeLimit == 0 && (poolFull || openLeaves == 0 || iterations >= capacity);
+}
+
+void MonteCarloAI::selectPath(MctsPath &path, uint8_t virtualLoss) {
+    MctsIndex current = 0;
+    path.nodes[0] = 0;
+    path.treeLength = 0;
+    nodes[0].visits += virtualLoss;
+    while (path.treeLength < MCTS_MAX_PLIES && nodes[current].childCount > 0) {
+        current = bestChild(nodes[current]);
+        nodes[current].visits += virtualLoss;
+        path.nodes[++path.treeLength] = current;
+    }
+}
+
+MctsIndex MonteCarloAI::bestChild(const MctsNode &node) const {
+    // Children that were never tried come first, in move order.
+    MctsIndex end = node.firstChild + node.childCount;
+    for (MctsIndex i = node.firstChild; i < end; i++) {
+        if (nodes[i].visits == 0) {
+            return i;
+        }
+    }
+    float logVisits = logf((float)node.visits);
+    MctsIndex best = node.firstChild;
+    float bestUct = -1.0f;
+    for (MctsIndex i = node.firstChild; i < end; i++) {
+        float visits = (float)nodes[i].visits;
+        float uct = nodes[i].points / (2.0f * visits) + MCTS_EXPLORATION * sqrtf(logVisits / visits);
+        if (uct > bestUct) {
+            bestUct = uct;
+            best = i;
+        }
+    }
+    return best;
+}
+
+bool MonteCarloAI::expand(MctsIndex leaf, const Move *moves, uint8_t count) {
+    if (nodes[leaf].childCount > 0) {
+        return true;  // Another thread got here first.
+    }
+    if (count > capacity - used) {
+        poolFull = true;
+        return false;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        MctsNode &child = nodes[used + i];
+        child.visits = 0;
+        child.points = 0;
+        child.firstChild = MCTS_UNEXPANDED;
+        child.childCount = 0;
+        child.move = moves[i];
+    }
+    nodes[leaf].firstChild = used;
+    nodes[leaf].childCount = count;
+    used += count;
+    openLeaves += count - 1;
+    return true;
+}
+
+void MonteCarloAI::close(MctsIndex leaf) {
+    if (nodes[leaf].firstChild == MCTS_UNEXPANDED) {
+        nodes[leaf].firstChild = MCTS_CLOSED;
+        openLeaves--;
+    }
+}
+
+void MonteCarloAI::backUp(const MctsPath &path, int8_t result, uint8_t virtualLoss) {
+    nodes[0].visits += 1 - virtualLoss;
+    for (uint8_t i = 1; i <= path.treeLength; i++) {
+        MctsNode &node = nodes[path.nodes[i]];
+        node.visits += 1 - virtualLoss;
+        node.points += 1 + result * path.movers[i - 1];
+    }
+}
+
+void MonteCarloAI::play(GameInterface *playGame, MctsPath &path, const Move &m, bool copyMake) {
+    if (copyMake) {
+        playGame->makeMove(m);
+    } else {
+        playGame->applyMove(m);
+    }
+    path.moves[path.length++] = m;
+}
+
+void MonteCarloAI::takeBack(GameInterface *playGame, const MctsPath &path, uint8_t *saved) {
+    if (saved != nullptr) {
+        memcpy(playGame->stateData(), saved, playGame->stateSize());
+        return;
+    }
+    for (uint8_t i = path.length; i > 0; i--) {
+        playGame->undoMove(path.moves[i - 1]);
+    }
+}
+
+void MonteCarloAI::finish() {
+    searching = false;
+    const MctsNode &root = nodes[0];
+    uint32_t mostVisits = 0;
+    for (MctsIndex i = root.firstChild; i < root.firstChild + root.childCount; i++) {
+        if (nodes[i].visits > mostVisits) {
+            mostVisits = nodes[i].visits;
+            bestMove = nodes[i].move;
+            bestValue = nodes[i].points / (2.0f * nodes[i].visits);
+        }
+    }
+    if (mostVisits == 0 && root.childCount > 0) {
+        // No playout finished (a time limit that was already up): any
+        // legal move is better than none.
+        bestMove = nodes[root.firstChild].move;
+    }
+}
@@ -0,0 +1,184 @@
+#ifndef MONTE_CARLO_AI_H
+#define MONTE_CARLO_AI_H
+
+#include "GameInterface.h"
+
+#if !defined(ARDUINO)
+#include <mutex>
+#endif
+
+// Longest line an iteration may play: tree moves plus the random playout.
+// A playout that reaches it is scored with evaluateBoard(). Games that undo
+// with applyMove/undoMove must be able to take back this many moves.
+#ifndef MCTS_MAX_PLIES
+#define MCTS_MAX_PLIES 40
+#endif
+
+// The UCT exploration constant. Larger values try weaker moves more often.
+#ifndef MCTS_EXPLORATION
+#define MCTS_EXPLORATION 1.41f
+#endif
+
+// Visits added to each node on the path of a playout in progress by a
+// parallel search, so other threads prefer different lines meanwhile.
+#ifndef MCTS_VIRTUAL_LOSS
+#define MCTS_VIRTUAL_LOSS 3
+#endif
+
+// Index of a node in the pool.
+typedef uint16_t MctsIndex;
+
+// firstChild of a node whose children have not been generated yet.
+#define MCTS_UNEXPANDED 0xFFFF
+
+// firstChild of a leaf that can never have children: the game is over
+// there or it is MCTS_MAX_PLIES deep.
+#define MCTS_CLOSED 0xFFFE
+
+// One node of the search tree. The children of a node are stored next to
+// each other in the pool, so a node only needs the index of the first.
+struct MctsNode {
+    uint32_t visits;       // Playouts through this node (plus virtual losses)
+    uint32_t points;       // Results for the side that moved here: 2 per win, 1 per draw
+    MctsIndex firstChild;  // Index of the first child, or MCTS_UNEXPANDED
+    uint8_t childCount;    // Number of children (0 until expanded)
+    Move move;             // Move that leads here from the parent
+};
+
+// The line played by one iteration, used to replay, score and take it back.
+struct MctsPath {
+    MctsIndex nodes[MCTS_MAX_PLIES + 1];  // Tree nodes from the root
+    int8_t movers[MCTS_MAX_PLIES];        // currentPlayer() before each tree move
+    Move moves[MCTS_MAX_PLIES];           // Every move applied, playout included
+    uint8_t treeLength;                   // Tree moves (nodes holds one more)
+    uint8_t length;                       // All moves applied
+};
+
+// The MonteCarloAI class searches with Monte Carlo Tree Search (UCT): it
+// grows a tree towards the moves that win the most random playouts and
+// plays the root move that was tried most often. It needs no evaluation
+// beyond the final result, which is the sign of evaluateBoard() at the end
+// of a playout.
+//
+// The tree lives in a node pool supplied by the caller, so it can be a
+// static array on the MCU; nothing is allocated while searching. When the
+// pool is full the tree stops growing but the playouts go on.
+//
+// Like MinimaxAI, a search can run to completion with findBestMove() or be
+// stepped from loop() with startSearch() / stepSearch().
+class MonteCarloAI {
+public:
+    // pool must hold poolSize nodes (at most 65535).
+    MonteCarloAI(GameInterface &gameRef, MctsNode *pool, uint16_t poolSize);
+
+    // Stop after this many playouts (0 = no limit). The default is 1000.
+    void setIterationLimit(uint32_t iterations);
+
+    // Stop after this many milliseconds (0 = no limit, the default).
+    // With neither limit the search stops once the pool is full, once no
+    // leaf can grow, or after one playout per pool node: a growing tree
+    // fills the pool long before that, so it only ends a search whose
+    // tree stopped growing (UCT may never revisit a losing line).
+    void setTimeLimit(uint32_t milliseconds);
+
+    // Seed the random playouts; searches are repeatable for a given seed.
+    void setSeed(uint32_t seed);
+
+    // Enable copy-make for games that expose their state (see
+    // GameInterface::stateSize()). The buffer must hold one state; each
+    // iteration then restores it instead of undoing its moves.
+    void setStateBuffer(void *buffer, uint16_t bytes);
+
+    // Finds and returns the best move for the current game state.
+    Move findBestMove();
+
+    // Begin a search of the current game state.
+    void startSearch();
+
+    // Run at most iterationBudget more playouts.
+    // Returns true once the search is complete and getResult() is valid.
+    bool stepSearch(uint16_t iterationBudget);
+
+    // Returns true while a started search has not yet completed.
+    bool isSearching() const;
+
+    // The most visited root move of the last completed search.
+    Move getResult() const;
+
+    // Average result of that move for the side to move: 0 = always lost,
+    // 0.5 = even, 1 = always won.
+    float getValue() const;
+
+    // Playouts run by the current or last search.
+    uint32_t getIterationCount() const;
+
+    // Nodes of the pool in use.
+    uint16_t getNodesUsed() const;
+
+#if !defined(ARDUINO)
+    // Tree parallelism: search with threadCount threads that share one tree.
+    // games holds threadCount game objects set to the engine's position
+    // (games[0] may be the engine's own game); each thread plays out with
+    // its own. Copy-make is used if the games support it. The limits apply
+    // to the search as a whole.
+    Move findBestMoveParallel(GameInterface *const *games, uint8_t threadCount);
+#endif
+
+private:
+    // One playout on the given game, which is left at the searched position.
+    // saved holds the root state for copy-make, or is nullptr.
+    // Returns false without playing out if the search is complete.
+    bool iterate(GameInterface *playGame, uint32_t &rng, uint8_t *saved, uint8_t virtualLoss);
+
+    // True once a limit has been reached.
+    bool finished() const;
+
+    // Walk down the tree by UCT, adding virtual loss along the way.
+    void selectPath(MctsPath &path, uint8_t virtualLoss);
+
+    // The child of a node with the highest UCT value.
+    MctsIndex bestChild(const MctsNode &node) const;
+
+    // Give a leaf its children. Returns false if the pool is full.
+    bool expand(MctsIndex leaf, const Move *moves, uint8_t count);
+
+    // Mark a leaf that cannot have children.
+    void close(MctsIndex leaf);
+
+    // Add a result (+1 maximizing player won, 0 draw, -1 lost) to every
+    // node on the path and remove the virtual loss.
+    void backUp(const MctsPath &path, int8_t result, uint8_t virtualLoss);
+
+    // Play / take back a move of an iteration.
+    void play(GameInterface *playGame, MctsPath &path, const Move &m, bool copyMake);
+    void takeBack(GameInterface *playGame, const MctsPath &path, uint8_t *saved);
+
+    // Pick the most visited root move as the result.
+    void finish();
+
+    GameInterface *game;   // Pointer to the game object
+    MctsNode *nodes;       // The node pool; nodes[0] is the root
+    uint16_t capacity;     // Nodes in the pool
+    uint16_t used;         // Nodes handed out so far
+    bool poolFull;         // An expansion did not fit
+    uint16_t openLeaves;   // Leaves that may still be expanded
+
+    uint32_t iterationLimit;
+    uint32_t timeLimit;
+    unsigned long startTime;
+    uint32_t iterations;   // Playouts started by the current search
+    uint32_t seed;         // State of the random generator
+
+    bool searching;        // True while a search is in progress
+    Move bestMove;         // Result of the last completed search
+    float bestValue;
+
+    uint8_t *stateBuffer;  // Saved root state for copy-make (optional)
+    uint16_t stateBufferBytes;
+
+#if !defined(ARDUINO)
+    std::mutex *treeLock;  // Held for tree updates during a parallel search
+#endif
+};
+
+#endif // MONTE_CARLO_AI_H
@@ -0,0 +1,89 @@
+#include "PersistentTable.h"
+
+#if !defined(ARDUINO)
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char PERSISTENT_TABLE_MAGIC[8] = { 'M', 'M', 'A', 'X', 'T', 'T', '1', '\0' };
+
+PersistentTable::PersistentTable()
+    : mapping(nullptr), mappingSize(0), warm(false) {
+}
+
+PersistentTable::~PersistentTable() {
+    close();
+}
+
+bool PersistentTable::open(const char *path, uint32_t entryCount, uint32_t gameId) {
+    close();
+
+    int fd = ::open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return false;
+    }
+
+    size_t size = sizeof(PersistentTableHeader) + (size_t)entryCount * sizeof(TTEntry);
+    struct stat info;
+    bool reuse = false;
+    if (fstat(fd, &info) == 0 && (size_t)info.st_size == size) {
+        PersistentTableHeader header;
+        if (pread(fd, &header, sizeof(header), 0) == (ssize_t)sizeof(header)) {
+            reuse = memcmp(header.magic, PERSISTENT_TABLE_MAGIC, sizeof(header.magic)) == 0 &&
+                    header.byteOrder == 0x01020304 &&
+                    header.version == PERSISTENT_TABLE_VERSION &&
+                    header.entrySize == sizeof(TTEntry) &&
+                    header.entryCount == entryCount &&
+                    header.gameId == gameId;
+        }
+    }
+
+    if (!reuse) {
+        // Start over with an empty table: truncating zero-fills every slot.
+        PersistentTableHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, PERSISTENT_TABLE_MAGIC, sizeof(header.magic));
+        header.byteOrder = 0x01020304;
+        header.version = PERSISTENT_TABLE_VERSION;
+        header.entrySize = sizeof(TTEntry);
+        header.entryCount = entryCount;
+        header.gameId = gameId;
+        if (ftruncate(fd, 0) != 0 || ftruncate(fd, (off_t)size) != 0 ||
+            pwrite(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) {
+            ::close(fd);
+            return false;
+        }
+    }
+
+    void *map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+
+    mapping = map;
+    mappingSize = size;
+    warm = reuse;
+    attach((TTEntry *)((uint8_t *)map + sizeof(PersistentTableHeader)), entryCount);
+    return true;
+}
+
+bool PersistentTable::isWarm() const {
+    return warm;
+}
+
+void PersistentTable::close() {
+    if (mapping != nullptr) {
+        msync(mapping, mappingSize, MS_SYNC);
+        munmap(mapping, mappingSize);
+        mapping = nullptr;
+        mappingSize = 0;
+        attach(nullptr, 0);
+    }
+    warm = false;
+}
+
+#endif // !ARDUINO
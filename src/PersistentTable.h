@@ -0,0 +1,52 @@
+#ifndef PERSISTENT_TABLE_H
+#define PERSISTENT_TABLE_H
+
+// A transposition table kept in a memory-mapped file so that search results
+// survive between runs. Host builds only (POSIX mmap); compiled out for
+// Arduino targets.
+#if !defined(ARDUINO)
+
+#include "TranspositionTable.h"
+
+// Bump when the file layout or the meaning of its entries changes.
+#define PERSISTENT_TABLE_VERSION 1
+
+// The 64-byte header at the start of the file. The TTEntry slots follow it.
+// Files are in host byte order; byteOrder detects files from another host.
+struct PersistentTableHeader {
+    char magic[8];        // "MMAXTT1\0"
+    uint32_t byteOrder;   // 0x01020304 as written by the host
+    uint16_t version;     // PERSISTENT_TABLE_VERSION
+    uint16_t entrySize;   // sizeof(TTEntry)
+    uint32_t entryCount;  // Number of slots (a power of two)
+    uint32_t gameId;      // Caller's id for the game and its key scheme
+    uint8_t reserved[40];
+};
+
+class PersistentTable : public TranspositionTable {
+public:
+    PersistentTable();
+    ~PersistentTable();
+
+    // Map the table file at path. A missing file, or one written with a
+    // different version, entry layout, size or gameId, is replaced by an
+    // empty table of entryCount slots (a power of two). Existing entries are
+    // used in place, with no loading step. Returns false if the file cannot
+    // be created or mapped. The table must be open before it is searched with.
+    bool open(const char *path, uint32_t entryCount, uint32_t gameId);
+
+    // True if open() reused the entries of an existing file.
+    bool isWarm() const;
+
+    // Write changes back to the file and unmap it.
+    void close();
+
+private:
+    void *mapping;      // Header followed by the entries
+    size_t mappingSize;
+    bool warm;
+};
+
+#endif // !ARDUINO
+
+#endif // PERSISTENT_TABLE_H
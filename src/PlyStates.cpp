@@ -0,0 +1,20 @@
+#include "PlyStates.h"
+
+PlyStates::PlyStates()
+    : game(nullptr), buffer(nullptr), bufferBytes(0), data(nullptr), stateBytes(0) {
+}
+
+void PlyStates::setBuffer(void *bufferRef, uint16_t bytes) {
+    buffer = (uint8_t *)bufferRef;
+    bufferBytes = bytes;
+}
+
+void PlyStates::prepare(GameInterface *gameRef, uint8_t plies) {
+    // Use copy-make if the game supports it and the buffer is large enough.
+    game = gameRef;
+    stateBytes = game->stateSize();
+    data = (uint8_t *)game->stateData();
+    if (buffer == nullptr || data == nullptr || (uint16_t)stateBytes * plies > bufferBytes) {
+        stateBytes = 0;
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef PLY_STATES_H
+#define PLY_STATES_H
+
+#include "GameInterface.h"
+
+// Copy-make for the depth-first engines (MinimaxAI, ProofNumberSolver).
+// Before a move is made at a ply, the game's state is saved in that ply's
+// slot of a buffer supplied by the caller; taking the move back copies the
+// state back instead of undoing it. Games that do not expose their state,
+// or a buffer too small for the search, fall back to applyMove/undoMove.
+class PlyStates {
+public:
+    PlyStates();
+
+    // The buffer to save states in: one state per ply of the search.
+    void setBuffer(void *buffer, uint16_t bytes);
+
+    // Decide between copy-make and undo before searching the game up to
+    // plies plies deep.
+    void prepare(GameInterface *gameRef, uint8_t plies);
+
+    // Play / take back the move searched at a ply. Called for every node,
+    // so they are inline.
+    void makeMove(uint8_t atPly, const Move &m) {
+        if (stateBytes != 0) {
+            memcpy(buffer + atPly * stateBytes, data, stateBytes);
+            game->makeMove(m);
+        } else {
+            game->applyMove(m);
+        }
+    }
+    void unmakeMove(uint8_t atPly, const Move &m) {
+        if (stateBytes != 0) {
+            memcpy(data, buffer + atPly * stateBytes, stateBytes);
+        } else {
+            game->undoMove(m);
+        }
+    }
+
+private:
+    GameInterface *game;   // The game being searched
+    uint8_t *buffer;       // Per-ply saved states (optional)
+    uint16_t bufferBytes;
+    uint8_t *data;         // The game's live state
+    uint8_t stateBytes;    // Size of one state; 0 when copy-make is off
+};
+
+#endif // PLY_STATES_H
@@ -0,0 +1,268 @@
+#include "ProofNumberSolver.h"
+
+constexpr size_t ProofNumberSolver::SEARCH_STACK_BYTES;
+
+// Depth stored for game results, which hold however deep the search goes.
+#define PROOF_EXACT_DEPTH 0xFF
+
+// The first slot of the two-slot bucket for a key. Keys are mixed first, as
+// games often pack their positions into keys whose low bits vary little.
+static inline uint32_t proofBucket(uint32_t key, uint32_t mask) {
+    key ^= key >> 16;
+    key *= 0x45D9F3BUL;
+    key ^= key >> 16;
+    return key & mask & ~1UL;
+}
+
+// Sum of proof numbers. A sum of infinities is infinite, but a finite sum
+// stops just below it: positions that are reached again along several
+// lines, as in king endgames, are counted once per line and can add up to
+// huge numbers without being solved.
+static inline ProofNumber proofAdd(ProofNumber a, ProofNumber b) {
+    if (a >= PROOF_INFINITY || b >= PROOF_INFINITY) {
+        return PROOF_INFINITY;
+    }
+    return (a + b >= PROOF_INFINITY) ? PROOF_INFINITY - 1 : a + b;
+}
+
+ProofNumberSolver::ProofNumberSolver(GameInterface &gameRef, ProofEntry *entries, uint32_t count)
+    : game(&gameRef), table(entries), mask(count - 1), maxPly(PROOF_MAX_PLY), ply(0), attacker(1),
+      nodes(0), proofMove({0, 0}) {
+    clear();
+}
+
+void ProofNumberSolver::setMaxPly(uint8_t plies) {
+    maxPly = (plies > PROOF_MAX_PLY) ? PROOF_MAX_PLY : plies;
+}
+
+void ProofNumberSolver::setStateBuffer(void *buffer, uint16_t bytes) {
+    states.setBuffer(buffer, bytes);
+}
+
+Move ProofNumberSolver::getProofMove() const {
+    return proofMove;
+}
+
+uint32_t ProofNumberSolver::getNodeCount() const {
+    return nodes;
+}
+
+void ProofNumberSolver::clear() {
+    memset(table, 0, (mask + 1) * sizeof(ProofEntry));
+}
+
+ProofResult ProofNumberSolver::solve(uint32_t nodeBudget) {
+    nodes = 0;
+    proofMove = {0, 0};
+
+    states.prepare(game, maxPly);
+    uint32_t key;
+    if (!game->positionKey(key)) {
+        return PROOF_UNKNOWN;
+    }
+
+    // First: can the side to move force a win?
+    int8_t side = (game->currentPlayer() > 0) ? 1 : -1;
+    ProofNumber pn, dn;
+    prove(side, nodeBudget, pn, dn);
+    if (pn == 0) {
+        return PROOF_WIN;
+    }
+    if (dn != 0) {
+        return PROOF_UNKNOWN;
+    }
+
+    // It cannot, so it at least draws unless the opponent can force a win.
+    Move tryMove = proofMove;
+    prove(-side, nodeBudget, pn, dn);
+    if (pn == 0) {
+        return PROOF_LOSS;
+    }
+    if (dn == 0) {
+        return PROOF_DRAW;
+    }
+    proofMove = tryMove;
+    return PROOF_UNKNOWN;
+}
+
+void ProofNumberSolver::prove(int8_t attackerSign, uint32_t nodeBudget, ProofNumber &pn, ProofNumber &dn) {
+    attacker = attackerSign;
+    ply = 0;
+    if (!enter(PROOF_INFINITY, PROOF_INFINITY, pn, dn)) {
+        return;  // The game is over (or the ply limit is 0).
+    }
+
+    for (;;) {
+        ProofFrame &frame = frames[ply];
+        uint8_t best;
+        ProofNumber bestPn, bestDn, second;
+        combine(frame, pn, dn, best, bestPn, bestDn, second);
+
+        if (pn >= frame.thpn || dn >= frame.thdn || nodes >= nodeBudget) {
+            // Done with this position for now (or out of budget: unwind).
+            store(frame.key, maxPly - ply, pn, dn, nodes - frame.nodesIn + 1);
+            if (ply == 0) {
+                proofMove = (frame.count > 0) ? frame.moves[best] : Move{0, 0};
+                return;
+            }
+            ply--;
+            states.unmakeMove(ply, frames[ply].moves[frames[ply].child]);
+            frames[ply].returned = true;
+            frames[ply].childPn = pn;
+            frames[ply].childDn = dn;
+            continue;
+        }
+
+        // Search the most promising child until it is no longer the most
+        // promising one or this position reaches its thresholds.
+        ProofNumber thpn, thdn;
+        if (frame.orNode) {
+            ProofNumber w = (second >= PROOF_INFINITY) ? PROOF_INFINITY : second + second / 4 + 1;
+            thpn = (w < frame.thpn) ? w : frame.thpn;
+            thdn = frame.thdn - dn + bestDn;
+        } else {
+            ProofNumber w = (second >= PROOF_INFINITY) ? PROOF_INFINITY : second + second / 4 + 1;
+            thdn = (w < frame.thdn) ? w : frame.thdn;
+            thpn = frame.thpn - pn + bestPn;
+        }
+        frame.child = best;
+        states.makeMove(ply, frame.moves[best]);
+        nodes++;
+        ply++;
+        if (!enter(thpn, thdn, frame.childPn, frame.childDn)) {
+            ply--;
+            states.unmakeMove(ply, frame.moves[best]);
+            frame.returned = true;
+        }
+    }
+}
+
+bool ProofNumberSolver::enter(ProofNumber thpn, ProofNumber thdn, ProofNumber &pn, ProofNumber &dn) {
+    uint32_t key = 0;
+    tableKey(key);
+    uint8_t depth = maxPly - ply;
+
+    // The root is always expanded, so that a solved root still yields its move.
+    lookup(key, depth, pn, dn);
+    if (ply > 0 && (pn >= thpn || dn >= thdn)) {
+        return false;
+    }
+
+    if (game->isGameOver()) {
+        int eval = game->evaluateBoard();
+        bool won = (attacker > 0) ? (eval >= SCORE_WIN) : (eval <= -SCORE_WIN);
+        pn = won ? 0 : PROOF_INFINITY;
+        dn = won ? PROOF_INFINITY : 0;
+        store(key, PROOF_EXACT_DEPTH, pn, dn, 0);
+        return false;
+    }
+    if (depth == 0) {
+        // The ply limit: not won as far as this search can tell.
+        pn = PROOF_INFINITY;
+        dn = 0;
+        store(key, 0, pn, dn, 0);
+        return false;
+    }
+
+    ProofFrame &frame = frames[ply];
+    frame.count = game->generateMoves(frame.moves);
+    frame.child = 0;
+    frame.returned = false;
+    frame.orNode = ((game->currentPlayer() > 0 ? 1 : -1) == attacker);
+    frame.key = key;
+    frame.thpn = thpn;
+    frame.thdn = thdn;
+    frame.nodesIn = nodes;
+    return true;
+}
+
+void ProofNumberSolver::combine(ProofFrame &frame, ProofNumber &pn, ProofNumber &dn, uint8_t &best,
+                                ProofNumber &bestPn, ProofNumber &bestDn, ProofNumber &second) {
+    // At an attacker node one proven child proves it and all children must
+    // be disproven to disprove it; a defender node is the other way round.
+    ProofNumber sum = 0;
+    ProofNumber least = PROOF_INFINITY;
+    second = PROOF_INFINITY;
+    best = 0;
+    bestPn = bestDn = PROOF_INFINITY;
+    uint8_t depth = maxPly - ply - 1;
+    for (uint8_t i = 0; i < frame.count; i++) {
+        uint32_t key;
+        ProofNumber cpn, cdn;
+        states.makeMove(ply, frame.moves[i]);
+        tableKey(key);
+        states.unmakeMove(ply, frame.moves[i]);
+        if (!lookup(key, depth, cpn, cdn) && frame.returned && i == frame.child) {
+            cpn = frame.childPn;
+            cdn = frame.childDn;
+        }
+
+        ProofNumber minimized = frame.orNode ? cpn : cdn;
+        sum = proofAdd(sum, frame.orNode ? cdn : cpn);
+        if (minimized < least) {
+            second = least;
+            least = minimized;
+            best = i;
+            bestPn = cpn;
+            bestDn = cdn;
+        } else if (minimized < second) {
+            second = minimized;
+        }
+    }
+    pn = frame.orNode ? least : sum;
+    dn = frame.orNode ? sum : least;
+}
+
+bool ProofNumberSolver::lookup(uint32_t key, uint8_t depth, ProofNumber &pn, ProofNumber &dn) const {
+    const ProofEntry *bucket = &table[proofBucket(key, mask)];
+    const ProofEntry &slot = (bucket[0].key == key) ? bucket[0] : bucket[1];
+    pn = dn = 1;
+    if (slot.key != key || key == 0) {
+        return false;
+    }
+    // A disproof found with fewer plies left may only be the ply limit, so
+    // it does not hold when there is more room to search.
+    if (slot.dn == 0 && slot.depth < depth) {
+        return false;
+    }
+    pn = slot.pn;
+    dn = slot.dn;
+    return true;
+}
+
+void ProofNumberSolver::store(uint32_t key, uint8_t depth, ProofNumber pn, ProofNumber dn, uint32_t work) {
+    // Update the position's own slot, or else fill an empty one, or else
+    // replace the one that took less work (game results take none). The
+    // entry that stays loses half its work, so that an old entry cannot
+    // hold its slot forever while two newer ones keep evicting each other.
+    ProofEntry *bucket = &table[proofBucket(key, mask)];
+    uint8_t i;
+    if (bucket[0].key == key || bucket[1].key == key) {
+        i = (bucket[0].key == key) ? 0 : 1;
+    } else if (bucket[0].key == 0 || bucket[1].key == 0) {
+        i = (bucket[0].key == 0) ? 0 : 1;
+    } else {
+        i = (bucket[1].work < bucket[0].work) ? 1 : 0;
+        bucket[1 - i].work >>= 1;
+    }
+    ProofEntry &slot = bucket[i];
+    if (slot.key == key) {
+        work += slot.work;
+    }
+    slot.work = (work > 0xFFFF) ? 0xFFFF : (uint16_t)work;
+    slot.key = key;
+    slot.pn = pn;
+    slot.dn = dn;
+    slot.depth = depth;
+}
+
+bool ProofNumberSolver::tableKey(uint32_t &key) {
+    if (!game->positionKey(key)) {
+        return false;
+    }
+    // The two questions solve() asks get separate entries.
+    if (attacker < 0) {
+        key ^= 0x9E3779B9UL;
+    }
+    return true;
+}
@@ -0,0 +1,135 @@
+#ifndef PROOF_NUMBER_SOLVER_H
+#define PROOF_NUMBER_SOLVER_H
+
+#include "GameInterface.h"
+#include "PlyStates.h"
+
+// Longest line the solver follows. Positions this far from the root count as
+// not won, so a draw means neither side can force a win within this many
+// plies. Like MINIMAX_MAX_PLY, override it with a compiler flag.
+#ifndef PROOF_MAX_PLY
+#define PROOF_MAX_PLY 32
+#endif
+
+// Proof and disproof numbers: the number of leaf positions that still have
+// to be solved to prove, or disprove, that the attacker wins.
+typedef uint32_t ProofNumber;
+#define PROOF_INFINITY 0x0FFFFFFFUL
+
+// The answer of a solve, for the side to move.
+enum ProofResult {
+    PROOF_UNKNOWN = 0,  // The node budget ran out first
+    PROOF_WIN     = 1,  // The side to move can force a win
+    PROOF_LOSS    = 2,  // The opponent can force a win
+    PROOF_DRAW    = 3   // Neither side can force a win within the ply limit
+};
+
+// One slot of the solver's hash area.
+struct ProofEntry {
+    uint32_t key;    // Position key (0 = empty)
+    ProofNumber pn;  // Proof number
+    ProofNumber dn;  // Disproof number
+    uint16_t work;   // Nodes searched below the position (saturating)
+    uint8_t depth;   // Plies left below the position when it was searched
+};
+
+// Per-ply state of the depth-first search. All plies live in one statically
+// sized array inside ProofNumberSolver; the search does not recurse.
+struct ProofFrame {
+    Move moves[MAX_MOVES];  // Moves generated at this ply
+    uint8_t count;          // Number of moves in the list
+    uint8_t child;          // Move currently being searched
+    bool returned;          // childPn and childDn hold that child's last result
+    bool orNode;            // The attacker is to move
+    uint32_t key;           // Key of the position
+    ProofNumber thpn;       // Thresholds the ply was entered with
+    ProofNumber thdn;
+    ProofNumber childPn;    // Numbers the searched child came back with, used
+    ProofNumber childDn;    // if the hash area has lost them since
+    uint32_t nodesIn;       // Node count when the ply was entered
+};
+
+// The ProofNumberSolver class decides whether a position is won, lost or
+// drawn with depth-first proof-number search (df-pn). Instead of scoring
+// positions it counts how many leaves are left to prove or refute a win and
+// always works on the most promising line, so narrow forcing lines such as
+// king endgames are solved with far fewer nodes than a full-width search.
+// Only game results count: +/-SCORE_WIN from evaluateBoard() at the end of
+// the game is a win, anything else is a draw.
+//
+// The search is bounded by a node budget, and its results live in a
+// fixed-size hash area supplied by the caller. A full area keeps the
+// entries that took the most work, but one that is far too small for the
+// problem makes the search go round in circles until the budget runs out.
+// The game must provide positionKey().
+class ProofNumberSolver {
+public:
+    // SRAM used by the search stack, fixed at compile time.
+    static constexpr size_t SEARCH_STACK_BYTES = sizeof(ProofFrame) * PROOF_MAX_PLY;
+
+    // entries must point to count slots; count must be a power of two
+    // (at least 2).
+    ProofNumberSolver(GameInterface &gameRef, ProofEntry *entries, uint32_t count);
+
+    // Limit the length of the lines searched (clamped to PROOF_MAX_PLY).
+    void setMaxPly(uint8_t plies);
+
+    // Enable copy-make for games that expose their state (see
+    // GameInterface::stateSize()). The buffer must hold one state per ply
+    // of the ply limit, otherwise applyMove/undoMove are used.
+    void setStateBuffer(void *buffer, uint16_t bytes);
+
+    // Solve the current position, visiting at most nodeBudget nodes.
+    ProofResult solve(uint32_t nodeBudget);
+
+    // The move to play after solve(): the winning move after a win, a
+    // drawing move after a draw, and otherwise the most stubborn defence
+    // or the most promising try.
+    Move getProofMove() const;
+
+    // Number of nodes visited by the last solve.
+    uint32_t getNodeCount() const;
+
+    // Empty the hash area.
+    void clear();
+
+private:
+    // Search until the root is proven or disproven that the player with the
+    // sign attackerSign wins, or until the budget is used up. Returns the
+    // root's numbers and sets proofMove.
+    void prove(int8_t attackerSign, uint32_t nodeBudget, ProofNumber &pn, ProofNumber &dn);
+
+    // Set up the frame for the position at the current ply. Returns false
+    // if it need not be expanded: it is solved, at the ply limit, or its
+    // stored numbers already reach the thresholds. pn and dn are then its
+    // numbers.
+    bool enter(ProofNumber thpn, ProofNumber thdn, ProofNumber &pn, ProofNumber &dn);
+
+    // Combine the numbers of the frame's children. best is the child to
+    // search next and second the runner-up's number.
+    void combine(ProofFrame &frame, ProofNumber &pn, ProofNumber &dn, uint8_t &best,
+                 ProofNumber &bestPn, ProofNumber &bestDn, ProofNumber &second);
+
+    // Read the numbers of a position. Returns false for an unknown
+    // position, which counts as 1/1.
+    bool lookup(uint32_t key, uint8_t depth, ProofNumber &pn, ProofNumber &dn) const;
+    void store(uint32_t key, uint8_t depth, ProofNumber pn, ProofNumber dn, uint32_t work);
+
+    // The key of the current position for the current attacker.
+    bool tableKey(uint32_t &key);
+
+    GameInterface *game;   // Pointer to the game object
+    ProofEntry *table;     // The hash area
+    uint32_t mask;         // count - 1
+    uint8_t maxPly;        // Ply limit
+
+    ProofFrame frames[PROOF_MAX_PLY];  // Explicit search stack
+    uint8_t ply;           // Index of the active frame
+    int8_t attacker;       // Sign of the player trying to win
+    uint32_t nodes;        // Nodes visited by the current solve
+    Move proofMove;        // Result of the last solve
+
+    PlyStates states;      // Copy-make buffer (optional)
+};
+
+#endif // PROOF_NUMBER_SOLVER_H
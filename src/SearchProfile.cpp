@@ -0,0 +1,41 @@
+#include "SearchProfile.h"
+#include <string.h>
+
+#ifdef MINIMAX_PROFILE
+
+void SearchProfile::clear() {
+    memset(calls, 0, sizeof(calls));
+    memset(ticks, 0, sizeof(ticks));
+}
+
+// One row of the table. Name is a F() string.
+template <typename Name>
+static void printRow(Name name, uint32_t calls, ProfileTicks ticks, ProfileTicks total) {
+    Serial.print(name);
+    Serial.print(calls);
+    Serial.print(F(" calls, "));
+    Serial.print((unsigned long)(ticks / PROFILE_TICKS_PER_US));
+    Serial.print(F(" us, "));
+    Serial.print((unsigned int)(total ? (uint64_t)ticks * 100 / total : 0));
+    Serial.println(F("%"));
+}
+
+void SearchProfile::print() const {
+    ProfileTicks total = ticks[PROFILE_SEARCH];
+    ProfileTicks hooks = 0;
+    for (uint8_t i = 0; i < PROFILE_SEARCH; i++) {
+        hooks += ticks[i];
+    }
+    printRow(F("generateMoves: "), calls[PROFILE_GENERATE], ticks[PROFILE_GENERATE], total);
+    printRow(F("applyMove:     "), calls[PROFILE_APPLY], ticks[PROFILE_APPLY], total);
+    printRow(F("undoMove:      "), calls[PROFILE_UNDO], ticks[PROFILE_UNDO], total);
+    printRow(F("evaluateBoard: "), calls[PROFILE_EVALUATE], ticks[PROFILE_EVALUATE], total);
+    printRow(F("evaluateMoves: "), calls[PROFILE_BATCH], ticks[PROFILE_BATCH], total);
+    printRow(F("isGameOver:    "), calls[PROFILE_GAME_OVER], ticks[PROFILE_GAME_OVER], total);
+    printRow(F("positionKey:   "), calls[PROFILE_KEY], ticks[PROFILE_KEY], total);
+    // Everything else: the search's own bookkeeping and the timing itself.
+    printRow(F("other:         "), calls[PROFILE_SEARCH], total > hooks ? total - hooks : 0, total);
+    printRow(F("search:        "), calls[PROFILE_SEARCH], total, total);
+}
+
+#endif // MINIMAX_PROFILE
@@ -0,0 +1,92 @@
+#ifndef SEARCH_PROFILE_H
+#define SEARCH_PROFILE_H
+
+#include <Arduino.h>
+#include <stdint.h>
+
+// Define MINIMAX_PROFILE (as a compiler flag, like MINIMAX_MAX_PLY) to count
+// and time every GameInterface call the search makes; see
+// MinimaxAI::printProfile(). Without it PROFILE_SCOPE() expands to nothing.
+#ifdef MINIMAX_PROFILE
+
+#if !defined(ARDUINO)
+#include <chrono>
+#endif
+
+// The timed parts of a search.
+enum ProfileHook {
+    PROFILE_GENERATE,   // generateMoves()
+    PROFILE_APPLY,      // applyMove() or makeMove() plus the copy-make save
+    PROFILE_UNDO,       // undoMove() or the copy-make restore
+    PROFILE_EVALUATE,   // evaluateBoard()
+    PROFILE_BATCH,      // evaluateMoves(), counted per board scored
+    PROFILE_GAME_OVER,  // isGameOver()
+    PROFILE_KEY,        // positionKey()
+    PROFILE_SEARCH,     // The whole search, hooks included
+    PROFILE_COUNT
+};
+
+#if defined(ARDUINO)
+// micros(): 4 us resolution on 16 MHz AVR, so short hooks are measured
+// statistically over many calls. Each reading also costs a few us.
+typedef uint32_t ProfileTicks;
+#define PROFILE_TICKS_PER_US 1
+inline ProfileTicks profileClock() { return micros(); }
+#else
+// steady_clock in nanoseconds.
+typedef uint64_t ProfileTicks;
+#define PROFILE_TICKS_PER_US 1000
+inline ProfileTicks profileClock() {
+    using namespace std::chrono;
+    return (ProfileTicks)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+// Call counts and time per hook for one search.
+struct SearchProfile {
+    uint32_t calls[PROFILE_COUNT];
+    ProfileTicks ticks[PROFILE_COUNT];
+
+    void clear();
+
+    // Print a table of calls, time and share of the search time to Serial.
+    void print() const;
+};
+
+// Adds the time from construction to destruction to one hook.
+class ProfileScope {
+public:
+    ProfileScope(SearchProfile &profileRef, ProfileHook hookId)
+        : profile(profileRef), hook(hookId), calls(1), start(profileClock()) {
+    }
+    ~ProfileScope() {
+        profile.calls[hook] += calls;
+        profile.ticks[hook] += profileClock() - start;
+    }
+
+    // Count the scope as this many calls instead of one.
+    void setCalls(uint16_t count) {
+        calls = count;
+    }
+
+private:
+    SearchProfile &profile;
+    ProfileHook hook;
+    uint16_t calls;
+    ProfileTicks start;
+};
+
+// Time the rest of the enclosing block; needs a SearchProfile named profile.
+#define PROFILE_SCOPE(hook) ProfileScope profileScope(profile, hook)
+
+// Count the enclosing PROFILE_SCOPE() as count calls.
+#define PROFILE_CALLS(count) profileScope.setCalls(count)
+
+#else
+
+#define PROFILE_SCOPE(hook)
+#define PROFILE_CALLS(count)
+
+#endif // MINIMAX_PROFILE
+
+#endif // SEARCH_PROFILE_H
@@ -0,0 +1,74 @@
+#include "TranspositionTable.h"
+
+// Read and write entry fields: relaxed atomics on a host, plain accesses
+// on the MCU.
+#if !defined(ARDUINO)
+#define TT_LOAD(field) (field).load(std::memory_order_relaxed)
+#define TT_STORE(field, value) (field).store((value), std::memory_order_relaxed)
+#else
+#define TT_LOAD(field) (field)
+#define TT_STORE(field, value) ((field) = (value))
+#endif
+
+TranspositionTable::TranspositionTable(TTEntry *entries, uint32_t count)
+    : table(entries), mask(count - 1) {
+    clear();
+}
+
+TranspositionTable::TranspositionTable()
+    : table(nullptr), mask(0) {
+}
+
+void TranspositionTable::attach(TTEntry *entries, uint32_t count) {
+    table = entries;
+    mask = count - 1;
+}
+
+bool TranspositionTable::probe(uint32_t key, uint8_t &depth, TTBound &bound, Score &score, Move &move) const {
+    const TTEntry &slot = table[key & mask];
+    uint32_t data = TT_LOAD(slot.data);
+    uint16_t info = TT_LOAD(slot.info);
+    if ((TT_LOAD(slot.check) ^ data ^ info) != key || (info >> 8) == TT_NONE) {
+        return false;
+    }
+    score = (Score)(int16_t)(data & 0xFFFF);
+    move.from = (uint8_t)(data >> 16);
+    move.to = (uint8_t)(data >> 24);
+    depth = (uint8_t)(info & 0xFF);
+    bound = (TTBound)((info >> 8) & 0x3);
+    return true;
+}
+
+void TranspositionTable::store(uint32_t key, uint8_t depth, TTBound bound, Score score, const Move &move) {
+    if ((int16_t)score != score) {
+        return;  // Does not fit in an entry.
+    }
+    TTEntry &slot = table[key & mask];
+    uint32_t oldData = TT_LOAD(slot.data);
+    uint16_t oldInfo = TT_LOAD(slot.info);
+    uint32_t oldCheck = TT_LOAD(slot.check);
+    // Keep a deeper result for the same position.
+    if ((oldCheck ^ oldData ^ oldInfo) == key && (oldInfo >> 8) != TT_NONE && (oldInfo & 0xFF) > depth) {
+        return;
+    }
+    uint32_t data = (uint16_t)score | ((uint32_t)move.from << 16) | ((uint32_t)move.to << 24);
+    uint16_t info = depth | ((uint16_t)bound << 8);
+    if (data == oldData && info == oldInfo && oldCheck == (key ^ data ^ info)) {
+        return;
+    }
+    TT_STORE(slot.data, data);
+    TT_STORE(slot.info, info);
+    TT_STORE(slot.check, key ^ data ^ info);
+}
+
+void TranspositionTable::clear() {
+    for (uint32_t i = 0; i <= mask; i++) {
+        TT_STORE(table[i].check, 0);
+        TT_STORE(table[i].data, 0);
+        TT_STORE(table[i].info, 0);
+    }
+}
+
+uint32_t TranspositionTable::size() const {
+    return mask + 1;
+}
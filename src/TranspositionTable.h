@@ -0,0 +1,70 @@
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include "GameInterface.h"
+
+#if !defined(ARDUINO)
+#include <atomic>
+#endif
+
+// How a stored score relates to the true score of the position.
+enum TTBound {
+    TT_NONE  = 0,  // Empty slot
+    TT_EXACT = 1,  // The score is exact
+    TT_LOWER = 2,  // The true score is at least this (search failed high)
+    TT_UPPER = 3   // The true score is at most this (search failed low)
+};
+
+// The fields of an entry. On a host the table may be shared between
+// threads, so each field is an atomic accessed with relaxed ordering; the
+// check word below is what keeps the fields consistent with each other.
+#if !defined(ARDUINO)
+typedef std::atomic<uint32_t> TTWord;
+typedef std::atomic<uint16_t> TTHalfWord;
+#else
+typedef uint32_t TTWord;
+typedef uint16_t TTHalfWord;
+#endif
+
+// One stored search result. The fields are packed into two words plus a
+// check word (key ^ data ^ info) so that a slot half-written by another
+// thread is seen as a miss instead of a wrong result.
+struct TTEntry {
+    TTWord check;     // Position key XOR data XOR info
+    TTWord data;      // Score (low 16 bits), best move from and to
+    TTHalfWord info;  // Search depth (low 8 bits), bound (next 2 bits)
+};
+
+// A fixed-size table of search results indexed by GameInterface::positionKey().
+// The caller provides the storage, so it can live in a static array on the
+// MCU or be shared between several engines (and threads) on a host.
+class TranspositionTable {
+public:
+    // entries must point to count slots; count must be a power of two.
+    TranspositionTable(TTEntry *entries, uint32_t count);
+
+    // Look up a position. Returns true and fills the outputs on a hit.
+    bool probe(uint32_t key, uint8_t &depth, TTBound &bound, Score &score, Move &move) const;
+
+    // Store a result. An existing entry for the same position is only
+    // replaced by a result from an equal or deeper search, and an identical
+    // entry is not rewritten. Entries keep the score in 16 bits, so with a
+    // wider MINIMAX_SCORE_TYPE results whose score does not fit are dropped.
+    void store(uint32_t key, uint8_t depth, TTBound bound, Score score, const Move &move);
+
+    // Empty every slot.
+    void clear();
+
+    // Number of slots.
+    uint32_t size() const;
+
+protected:
+    // For tables whose storage is attached later (see PersistentTable).
+    TranspositionTable();
+    void attach(TTEntry *entries, uint32_t count);
+
+    TTEntry *table;
+    uint32_t mask;  // count - 1
+};
+
+#endif // TRANSPOSITION_TABLE_H